@@ -22,11 +22,15 @@
  */
 
 #include "adaptivesystem.h"
+#include "topologyreader.h"
+#include <fstream>
 
 /**
- * Empty constructor.
+ * Constructor.
+ *
+ * @param resource Supplies the storage of the edges
  */
-AdaptiveSystem::AdaptiveSystem() { }
+AdaptiveSystem::AdaptiveSystem(std::pmr::memory_resource* resource) : edges(resource) { }
 
 /**
  * Empty destructor.
@@ -75,46 +79,30 @@ bool AdaptiveSystem::Edge::operator==(const Edge& rhs) const
 }
 
 /**
- * Initialises the internal topology representation.
+ * Initialises the internal topology representation. The file is parsed as a stream
+ * and all links are inserted with one batch.
  *
  * @param filename The JSON filename containing the physical topology
+ * @throws std::runtime_error Unreadable or malformed file
  */
 void AdaptiveSystem::initTopo(const std::string& filename)
 {
-	ptree pt;
-	boost::property_tree::read_json(filename, pt);
-	ptree::const_iterator end = pt.end();
-	for(ptree::const_iterator it = pt.begin(); it != end; ++it)
-	{
-		if(!std::strcmp(it->first.c_str(), "number_of_nodes"))
-			continue;
+	std::ifstream file(filename, std::ios::binary);
+	if(!file)
+		throw std::runtime_error("AdaptiveSystem::initTopo(..): Cannot open " + filename);
 
-		ptree::const_iterator end2 = it->second.end();
-		for(ptree::const_iterator it2 = it->second.begin(); it2 != end2; ++it2)
-		{
-			ptree::const_iterator end3 = it2->second.end();
-			int src = 0; int dest = 0; int length = 0;
-			for(ptree::const_iterator it3 = it2->second.begin(); it3 != end3; ++it3)
+	std::vector<Edge> links;
+	TopologyReader(file).read([&links](int src, int dest, double length)
 			{
-				if(!std::strcmp(it3->first.c_str(), "nodes"))
-				{
-					int index = 0;
-					ptree::const_iterator end31 = it3->second.end();
-					for(ptree::const_iterator it31 = it3->second.begin(); it31 != end31; ++it31, ++index)
-					{
-						if(index == 0)
-							src = it31->second.get_value<int>();
-						if(index == 1)
-							dest = it31->second.get_value<int>();
-					}
-				}
-				if(!std::strcmp(it3->first.c_str(), "length"))
-					length = it3->second.get_value<int>();
-			}
-
-			insertEdge(src, dest, static_cast<double>(length));
-		}
-	}
+				Edge edge;
+				edge.edgeStart = src;
+				edge.edgeEnd = dest;
+				edge.weight = length;
+				links.push_back(edge);
+			});
+
+	// The whole topology is handed over at once, so it is built only one time
+	insertEdges(links);
 }
 
 /**
@@ -134,7 +122,62 @@ void AdaptiveSystem::insertEdge(int src, int dest, double weight) noexcept(false
 	edges.push_back(edge);
 }
 
+/**
+ * Inserts a batch of edges. Their IDs are assigned here, any given ones are ignored.
+ *
+ * @param batch The edges to be appended
+ */
+void AdaptiveSystem::insertEdges(std::span<const Edge> batch) noexcept(false)
+{
+	edges.reserve(edges.size() + batch.size());
+	for(const auto& link : batch)
+	{
+		AdaptiveSystem::Edge edge = link;
+		edge.id = ++edgeIdCnt;
+		edges.push_back(edge);
+	}
+}
+
+/**
+ * Removes all edges from a source to a destination node.
+ *
+ * @param src Source node
+ * @param dest Destination node
+ * @throws std::invalid_argument Non-existent edge
+ */
+void AdaptiveSystem::removeEdge(int src, int dest) noexcept(false)
+{
+	auto it = std::remove_if(edges.begin(), edges.end(), [src, dest](const Edge& edge)
+			{ return edge.edgeStart == src && edge.edgeEnd == dest; });
+	if(it == edges.end())
+		throw std::invalid_argument("AdaptiveSystem::removeEdge(..): Non-existent edge");
+
+	edges.erase(it, edges.end());
+}
+
+/**
+ * Changes the weight of all edges from a source to a destination node.
+ *
+ * @param src Source node
+ * @param dest Destination node
+ * @param weight The new weight
+ * @throws std::invalid_argument Non-existent edge
+ */
+void AdaptiveSystem::updateWeight(int src, int dest, double weight) noexcept(false)
+{
+	bool found = false;
+	for(auto& edge : edges)
+		if(edge.edgeStart == src && edge.edgeEnd == dest)
+		{
+			edge.weight = weight;
+			found = true;
+		}
+
+	if(!found)
+		throw std::invalid_argument("AdaptiveSystem::updateWeight(..): Non-existent edge");
+}
+
 /**
  * Used for producing edge IDs.
  */
-int AdaptiveSystem::edgeIdCnt = 0;
+std::atomic<long int> AdaptiveSystem::edgeIdCnt = 0;
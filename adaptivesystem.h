@@ -25,12 +25,13 @@
 #define ADAPTIVESYSTEM_H
 
 #include <functional>
+#include <atomic>
+#include <span>
+#include <memory_resource>
 #include <vector>
 #include <string>
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
-
-using boost::property_tree::ptree;
+#include <stdexcept>
+#include <algorithm>
 
 class AdaptiveSystem
 {
@@ -47,18 +48,21 @@ public:
 		bool operator==(const Edge&) const;
 	};
 
-	AdaptiveSystem();
+	AdaptiveSystem(std::pmr::memory_resource* = std::pmr::get_default_resource());
 	virtual ~AdaptiveSystem();
 	virtual std::vector<int> path(int, int) = 0;
 	virtual void insertEdge(int, int, double) noexcept(false);
+	virtual void insertEdges(std::span<const Edge>) noexcept(false);
+	virtual void removeEdge(int, int) noexcept(false);
+	virtual void updateWeight(int, int, double) noexcept(false);
 	virtual void clear() = 0;
 
 protected:
 	virtual void initTopo(const std::string&);
-	std::vector<Edge> edges;
+	std::pmr::vector<Edge> edges;
 
 private:
-	static int edgeIdCnt;
+	static std::atomic<long int> edgeIdCnt;
 };
 
 #endif // ADAPTIVESYSTEM_H
@@ -0,0 +1,356 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#include "adjacency.h"
+#include <cstring>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Constructor.
+ *
+ * @param resource Supplies the owned arrays
+ */
+Adjacency::Adjacency(std::pmr::memory_resource* resource) 
+		: offsets(resource), targets(resource), lengths(resource)
+{
+	image = nullptr;
+	imageSize = 0;
+	labelView = {};
+}
+
+/**
+ * Destructor that releases a mapped image.
+ */
+Adjacency::~Adjacency()
+{
+	unmap();
+}
+
+/**
+ * Builds the compressed adjacency from an edge sequence. Edges are bucketed
+ * by their start node with a counting sort, so the cost is O(N + E) and the
+ * insertion order of the edges leaving a node is preserved.
+ *
+ * @param edges The edges of the topology
+ * @param nodes The minimum number of nodes, for nodes left without any edge
+ * @throws std::invalid_argument Negative node id
+ */
+void Adjacency::build(const std::vector<AdaptiveSystem::Edge>& edges, int nodes) noexcept(false)
+{
+	int bound = std::max(nodes, 0);
+	for(const auto& edge : edges)
+	{
+		if(edge.edgeStart < 0 || edge.edgeEnd < 0)
+			throw std::invalid_argument("Adjacency::build(..): Negative node id");
+		bound = std::max(bound, std::max(edge.edgeStart, edge.edgeEnd) + 1);
+	}
+
+	offsets.assign(bound + 1, 0);
+	for(const auto& edge : edges)
+		++offsets[edge.edgeStart + 1];
+	for(int node = 0; node < bound; ++node)
+		offsets[node + 1] += offsets[node];
+
+	targets.resize(edges.size());
+	lengths.resize(edges.size());
+	std::vector<int> cursor(offsets.begin(), offsets.end() - 1);
+	for(const auto& edge : edges)
+	{
+		int slot = cursor[edge.edgeStart]++;
+		targets[slot] = edge.edgeEnd;
+		lengths[slot] = edge.weight;
+	}
+
+	unmap();
+	offsetView = offsets;
+	targetView = targets;
+	lengthView = lengths;
+}
+
+/**
+ * Writes the adjacency as a topology image: a header with the node and edge
+ * counts, followed by the offsets, the endpoints, the labels and, aligned to
+ * 8 bytes, the weights. The image has the in-memory layout, so map(..) uses
+ * it as it is.
+ *
+ * @param filename The image file
+ * @param labels The external id of every node
+ * @throws std::invalid_argument Not one label per node
+ * @throws std::runtime_error The file cannot be written
+ */
+void Adjacency::save(const std::string& filename, std::span<const int> labels) const noexcept(false)
+{
+	if(labels.size() != static_cast<std::size_t>(nodes()))
+		throw std::invalid_argument("Adjacency::save(..): One label per node is required");
+
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if(!file)
+		throw std::runtime_error("Adjacency::save(..): Cannot open " + filename);
+
+	Header header{};
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = IMAGE_VERSION;
+	header.nodes = nodes();
+	header.edges = edges();
+	std::vector<int> emptyOffsets(1, 0);
+	auto offs = offsetView.empty() ? std::span<const int>(emptyOffsets) : offsetView;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(offs.data()), offs.size_bytes());
+	file.write(reinterpret_cast<const char*>(targetView.data()), targetView.size_bytes());
+	file.write(reinterpret_cast<const char*>(labels.data()), labels.size_bytes());
+	std::size_t padding = (offs.size_bytes() + targetView.size_bytes() + labels.size_bytes()) 
+			% sizeof(double);
+	if(padding)
+		file.write("\0\0\0\0\0\0\0", sizeof(double) - padding);
+	file.write(reinterpret_cast<const char*>(lengthView.data()), lengthView.size_bytes());
+	if(!file)
+		throw std::runtime_error("Adjacency::save(..): Cannot write " + filename);
+}
+
+/**
+ * Maps a topology image read-only into memory. Nothing is parsed or copied, the
+ * pages are shared among all processes mapping the same file. Only the offsets
+ * and endpoints are validated, so a corrupt image cannot cause reads outside it.
+ *
+ * @param filename The image file
+ * @throws std::runtime_error The file cannot be mapped or is not a valid image
+ */
+void Adjacency::map(const std::string& filename) noexcept(false)
+{
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if(fd < 0)
+		throw std::runtime_error("Adjacency::map(..): Cannot open " + filename);
+
+	struct stat info;
+	if(::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(Header))
+	{
+		::close(fd);
+		throw std::runtime_error("Adjacency::map(..): Not a topology image " + filename);
+	}
+
+	std::size_t size = info.st_size;
+	void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if(data == MAP_FAILED)
+		throw std::runtime_error("Adjacency::map(..): Cannot map " + filename);
+
+	const auto* header = static_cast<const Header*>(data);
+	const char* bytes = static_cast<const char*>(data);
+	std::size_t indexBytes = (2 * header->nodes + 1 + header->edges) * sizeof(int);
+	std::size_t weightsAt = sizeof(Header) + indexBytes 
+			+ (sizeof(double) - indexBytes % sizeof(double)) % sizeof(double);
+	bool valid = std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 
+			&& header->version == IMAGE_VERSION
+			&& header->nodes < static_cast<std::uint64_t>(std::numeric_limits<int>::max())
+			&& header->edges < static_cast<std::uint64_t>(std::numeric_limits<int>::max())
+			&& weightsAt + header->edges * sizeof(double) <= size;
+
+	std::span<const int> offs, ends;
+	if(valid)
+	{
+		offs = std::span<const int>(reinterpret_cast<const int*>(bytes + sizeof(Header)), 
+				header->nodes + 1);
+		ends = std::span<const int>(offs.data() + offs.size(), header->edges);
+		valid = offs.front() == 0 && offs.back() == static_cast<int>(header->edges);
+		for(std::size_t i = 1; valid && i < offs.size(); ++i)
+			valid = offs[i - 1] <= offs[i];
+		for(std::size_t i = 0; valid && i < ends.size(); ++i)
+			valid = ends[i] >= 0 && ends[i] < static_cast<int>(header->nodes);
+	}
+	if(!valid)
+	{
+		::munmap(data, size);
+		throw std::runtime_error("Adjacency::map(..): Not a valid topology image " + filename);
+	}
+
+	clear();
+	image = data;
+	imageSize = size;
+	// An empty topology is stored with a single offset, the accessors expect none
+	offsetView = header->nodes ? offs : std::span<const int>();
+	targetView = ends;
+	labelView = std::span<const int>(ends.data() + ends.size(), header->nodes);
+	lengthView = std::span<const double>(reinterpret_cast<const double*>(bytes + weightsAt), 
+			header->edges);
+}
+
+/**
+ * Checks if a file starts like a topology image.
+ *
+ * @param filename The file
+ * @return bool Indication of a topology image
+ */
+bool Adjacency::isImage(const std::string& filename)
+{
+	std::ifstream file(filename, std::ios::binary);
+	char magic[sizeof(MAGIC)] = {};
+	file.read(magic, sizeof(magic));
+
+	return file && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+/**
+ * Returns if the adjacency is read from a mapped image.
+ *
+ * @return bool Indication of a mapped image
+ */
+bool Adjacency::mapped() const
+{
+	return image != nullptr;
+}
+
+/**
+ * Releases a mapped image.
+ */
+void Adjacency::unmap()
+{
+	if(image)
+		::munmap(image, imageSize);
+	image = nullptr;
+	imageSize = 0;
+	labelView = {};
+}
+
+/**
+ * Clears instance's state
+ */
+void Adjacency::clear()
+{
+	unmap();
+	std::pmr::vector<int>(offsets.get_allocator()).swap(offsets);
+	std::pmr::vector<int>(targets.get_allocator()).swap(targets);
+	std::pmr::vector<double>(lengths.get_allocator()).swap(lengths);
+	offsetView = {};
+	targetView = {};
+	lengthView = {};
+}
+
+/**
+ * Returns the number of node slots, i.e., the highest node id plus one.
+ *
+ * @return int Node slots
+ */
+int Adjacency::nodes() const
+{
+	return offsetView.empty() ? 0 : static_cast<int>(offsetView.size()) - 1;
+}
+
+/**
+ * Returns the number of stored edges.
+ *
+ * @return int Edge count
+ */
+int Adjacency::edges() const
+{
+	return static_cast<int>(targetView.size());
+}
+
+/**
+ * Returns the out-degree of a node. Unknown nodes have no neighbours.
+ *
+ * @param node The node
+ * @return int Its out-degree
+ */
+int Adjacency::degree(int node) const
+{
+	if(node < 0 || node >= nodes())
+		return 0;
+
+	return offsetView[node + 1] - offsetView[node];
+}
+
+/**
+ * Returns the endpoints of the edges leaving a node.
+ *
+ * @param node The node
+ * @return std::span<const int> Its neighbours
+ */
+std::span<const int> Adjacency::neighbours(int node) const
+{
+	if(node < 0 || node >= nodes())
+		return {};
+
+	return targetView.subspan(offsetView[node], degree(node));
+}
+
+/**
+ * Returns the weights of the edges leaving a node, parallel to neighbours(..).
+ *
+ * @param node The node
+ * @return std::span<const double> Weights of its edges
+ */
+std::span<const double> Adjacency::weights(int node) const
+{
+	if(node < 0 || node >= nodes())
+		return {};
+
+	return lengthView.subspan(offsetView[node], degree(node));
+}
+
+/**
+ * Returns the weight of the link between two nodes. Parallel edges are summed.
+ *
+ * @param src Link's startpoint
+ * @param dest Link's endpoint
+ * @return double The weight
+ * @throws std::invalid_argument No such link
+ */
+double Adjacency::weight(int src, int dest) const noexcept(false)
+{
+	auto neighs = neighbours(src);
+	auto lens = weights(src);
+	double weightSum = 0;
+	bool found = false;
+	for(std::size_t i = 0; i < neighs.size(); ++i)
+		if(neighs[i] == dest)
+		{
+			weightSum += lens[i];
+			found = true;
+		}
+
+	if(!found)
+		throw std::invalid_argument("Adjacency::weight(..): Non-existent link");
+
+	return weightSum;
+}
+
+/**
+ * Returns the external node ids stored inside a mapped image.
+ *
+ * @return std::span<const int> The id of every node, empty unless an image is mapped
+ */
+std::span<const int> Adjacency::labels() const
+{
+	return labelView;
+}
+
+/**
+ * Identifies topology images, the last byte is the layout's endianness.
+ */
+const char Adjacency::MAGIC[8] = {'L', 'A', 'P', 'A', 'T', 'H', '\0', 
+		static_cast<char>(std::endian::native == std::endian::little ? 'l' : 'b')};
@@ -0,0 +1,87 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#ifndef ADJACENCY_H
+#define ADJACENCY_H
+
+#include "adaptivesystem.h"
+#include <span>
+#include <vector>
+#include <memory_resource>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <limits>
+#include <bit>
+
+class Adjacency
+{
+public:
+	static const std::uint32_t IMAGE_VERSION = 2;
+	Adjacency(std::pmr::memory_resource* = std::pmr::get_default_resource());
+	Adjacency(const Adjacency&) = delete;
+	Adjacency& operator=(const Adjacency&) = delete;
+	~Adjacency();
+	void build(const std::vector<AdaptiveSystem::Edge>&, int = 0) noexcept(false);
+	void save(const std::string&, std::span<const int>) const noexcept(false);
+	void map(const std::string&) noexcept(false);
+	static bool isImage(const std::string&);
+	bool mapped() const;
+	void clear();
+	int nodes() const;
+	int edges() const;
+	int degree(int) const;
+	std::span<const int> neighbours(int) const;
+	std::span<const double> weights(int) const;
+	double weight(int, int) const noexcept(false);
+	std::span<const int> labels() const;
+
+private:
+	struct Header
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t reserved;
+		std::uint64_t nodes;
+		std::uint64_t edges;
+	};
+
+	static const char MAGIC[8];
+	void unmap();
+	// Owned storage, used unless a topology image is mapped
+	std::pmr::vector<int> offsets;
+	std::pmr::vector<int> targets;
+	std::pmr::vector<double> lengths;
+	// What the accessors read, either the owned storage or the mapped image
+	std::span<const int> offsetView;
+	std::span<const int> targetView;
+	std::span<const double> lengthView;
+	// External node ids stored inside a mapped image
+	std::span<const int> labelView;
+	void* image;
+	std::size_t imageSize;
+};
+
+#endif // ADJACENCY_H
@@ -0,0 +1,534 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#include "lasystem.h"
+#include "dijkstrasystem.h"
+#include "topologygenerator.h"
+#include "topologyreader.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory_resource>
+#include <sstream>
+#include <thread>
+
+/**
+ * Benchmark options, see usage().
+ */
+struct Options
+{
+	std::vector<int> sizes{20, 50, 100, 200};
+	std::vector<std::string> generators{"random"};
+	double degree = 4;
+	int queries = 100;
+	int iterations = LaSystem::ITERATIONS;
+	bool autoIterations = false;
+	double deadline = 0;
+	std::string feedback = "hops";
+	bool perDestination = false;
+	std::string scheme = "ri";
+	double rate = 0;
+	int stable = 200;
+	double probability = 0;
+	bool exact = true;
+	int threads = 0;
+	int walkers = 1;
+	std::string format = "table";
+	std::uint64_t seed = 1;
+	std::string topology;
+};
+
+/**
+ * Scalability, accuracy and latency of one topology.
+ */
+struct Report
+{
+	std::string topology;
+	int nodes = 0;
+	std::size_t links = 0;
+	double buildTime = 0;
+	std::size_t bytes = 0;
+	std::vector<double> latencies;
+	std::vector<double> exactLatencies;
+	std::vector<double> iterations;
+	std::vector<double> gaps;
+	int failed = 0;
+	int walkers = 1;
+	int threads = 0;
+	double throughput = 0;
+};
+
+/**
+ * One column of the results: its heading in the table, its key in CSV and JSON.
+ */
+struct Field
+{
+	const char* heading;
+	const char* key;
+	double value;
+	int precision;
+};
+
+/**
+ * Upstream resource that keeps count of the bytes held through it. Pool workers
+ * allocate through it as well, e.g., when cloning per-destination tables.
+ */
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+	std::atomic<std::size_t> live = 0;
+
+private:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override
+	{
+		void* memory = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		live.fetch_add(bytes, std::memory_order_relaxed);
+		return memory;
+	}
+
+	void do_deallocate(void* memory, std::size_t bytes, std::size_t alignment) override
+	{
+		std::pmr::new_delete_resource()->deallocate(memory, bytes, alignment);
+		live.fetch_sub(bytes, std::memory_order_relaxed);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+	{
+		return this == &other;
+	}
+};
+
+void usage(const char* name)
+{
+	std::cerr << "Usage: " << name << " [options]\n"
+			<< "  --sizes N,N,..     Node counts of the generated topologies (20,50,100,200)\n"
+			<< "  --generators G,..  Generated kinds: random, grid, scale-free, backbone (random)\n"
+			<< "  --degree D         Average node degree of random and scale-free topologies (4)\n"
+			<< "  --topology FILE    Benchmark a JSON topology instead\n"
+			<< "  --queries N        Random (src, dest) pairs per topology, and per batch (100)\n"
+			<< "  --iterations N     Iteration budget of every query, or auto (" << LaSystem::ITERATIONS << ")\n"
+			<< "  --deadline US      Latency limit of every query in microseconds, 0 disables (0)\n"
+			<< "  --stable N         Stop after N iterations without improvement, 0 disables (200)\n"
+			<< "  --feedback F       Feedback policy: hops, weight, latency or energy (hops)\n"
+			<< "  --scheme S         Reinforcement: ri, rp, pursuit or estimator (ri)\n"
+			<< "  --rate R           Learning rate of the scheme, 0 for its default (0)\n"
+			<< "  --per-destination B  Separate automata per destination, 0 or 1 (0)\n"
+			<< "  --probability P    Stop when every LA on the best path exceeds P, 0 disables (0)\n"
+			<< "  --exact B          Compare with the Dijkstra baseline, 0 or 1 (1)\n"
+			<< "  --threads N        Threads of the batch throughput run, 0 for all cores (0)\n"
+			<< "  --walkers N        Parallel walkers of every single query, see setWalkers (1)\n"
+			<< "  --format F         Output: table, csv or json, one JSON object per line (table)\n"
+			<< "  --seed S           Seed of the topologies, the queries and the LAs (1)\n";
+}
+
+bool parse(int argc, char* argv[], Options& options)
+{
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if(i + 1 >= argc)
+			return false;
+		std::string value = argv[++i];
+		if(arg == "--sizes")
+		{
+			options.sizes.clear();
+			std::stringstream list(value);
+			for(std::string size; std::getline(list, size, ','); )
+				options.sizes.push_back(std::stoi(size));
+		}
+		else if(arg == "--generators")
+		{
+			options.generators.clear();
+			std::stringstream list(value);
+			for(std::string kind; std::getline(list, kind, ','); )
+			{
+				if(kind != "random" && kind != "grid" && kind != "scale-free" && kind != "backbone")
+					return false;
+				options.generators.push_back(kind);
+			}
+		}
+		else if(arg == "--degree")
+			options.degree = std::stod(value);
+		else if(arg == "--topology")
+			options.topology = value;
+		else if(arg == "--queries")
+			options.queries = std::stoi(value);
+		else if(arg == "--iterations")
+		{
+			options.autoIterations = value == "auto";
+			if(!options.autoIterations)
+				options.iterations = std::stoi(value);
+		}
+		else if(arg == "--deadline")
+			options.deadline = std::stod(value);
+		else if(arg == "--stable")
+			options.stable = std::stoi(value);
+		else if(arg == "--feedback")
+		{
+			if(value != "hops" && value != "weight" && value != "latency" && value != "energy")
+				return false;
+			options.feedback = value;
+		}
+		else if(arg == "--scheme")
+		{
+			if(value != "ri" && value != "rp" && value != "pursuit" && value != "estimator")
+				return false;
+			options.scheme = value;
+		}
+		else if(arg == "--rate")
+			options.rate = std::stod(value);
+		else if(arg == "--per-destination")
+			options.perDestination = std::stoi(value) != 0;
+		else if(arg == "--probability")
+			options.probability = std::stod(value);
+		else if(arg == "--exact")
+			options.exact = std::stoi(value) != 0;
+		else if(arg == "--threads")
+			options.threads = std::stoi(value);
+		else if(arg == "--walkers")
+			options.walkers = std::stoi(value);
+		else if(arg == "--format")
+		{
+			if(value != "table" && value != "csv" && value != "json")
+				return false;
+			options.format = value;
+		}
+		else if(arg == "--seed")
+			options.seed = std::stoull(value);
+		else
+			return false;
+	}
+
+	return true;
+}
+
+LaSystem::Reinforcement scheme(const Options& options)
+{
+	if(options.scheme == "rp")
+	{
+		RewardPenalty scheme;
+		if(options.rate > 0)
+			scheme.reward = options.rate;
+		return scheme;
+	}
+	if(options.scheme == "pursuit")
+	{
+		Pursuit scheme;
+		if(options.rate > 0)
+			scheme.rate = options.rate;
+		return scheme;
+	}
+	if(options.scheme == "estimator")
+	{
+		Estimator scheme;
+		if(options.rate > 0)
+			scheme.rate = options.rate;
+		return scheme;
+	}
+
+	RewardInaction scheme;
+	if(options.rate > 0)
+		scheme.rate = options.rate;
+	return scheme;
+}
+
+/**
+ * Generates a topology of the given kind, a grid as square as the size allows.
+ */
+std::vector<AdaptiveSystem::Edge> generate(const std::string& kind, int nodes, const Options& options)
+{
+	TopologyGenerator generator(options.seed + nodes);
+	if(kind == "grid")
+	{
+		int rows = std::max(1, static_cast<int>(std::sqrt(nodes)));
+		return generator.grid(rows, std::max(1, nodes / rows));
+	}
+	if(kind == "scale-free")
+		return generator.scaleFree(nodes, options.degree);
+	if(kind == "backbone")
+		return generator.backbone(nodes);
+
+	return generator.random(nodes, options.degree);
+}
+
+double percentile(std::vector<double> values, double rank)
+{
+	if(values.empty())
+		return 0;
+	std::sort(values.begin(), values.end());
+	auto index = static_cast<std::size_t>(std::ceil(rank * values.size()));
+
+	return values[std::clamp<std::size_t>(index, 1, values.size()) - 1];
+}
+
+double mean(const std::vector<double>& values)
+{
+	double sum = 0;
+	for(double value : values)
+		sum += value;
+
+	return values.empty() ? 0 : sum / values.size();
+}
+
+/**
+ * Runs random queries one after the other. With the baseline only pairs with a
+ * path are queried and the learned paths are compared with the exact ones.
+ */
+void run(LaSystem& la, DijkstraSystem* exact, const std::vector<int>& ids, const Options& options, 
+		Report& report)
+{
+	using Clock = std::chrono::steady_clock;
+	SplitMix64 gen(options.seed);
+	for(int q = 0, attempts = 0; q < options.queries && attempts < 100 * options.queries; ++attempts)
+	{
+		int src = ids[gen() % ids.size()], dest = ids[gen() % ids.size()];
+		std::vector<int> best;
+		auto start = Clock::now();
+		if(exact)
+			best = exact->path(src, dest);
+		auto exactTime = Clock::now() - start;
+		if(exact && best.empty())
+			continue;
+
+		++q;
+		start = Clock::now();
+		auto learned = la.path(src, dest);
+		auto time = Clock::now() - start;
+		report.latencies.push_back(std::chrono::duration<double, std::micro>(time).count());
+		if(exact)
+			report.exactLatencies.push_back(std::chrono::duration<double, std::micro>(exactTime).count());
+		report.iterations.push_back(la.lastIterations());
+		try
+		{
+			if(learned.empty() || learned.front() != src || learned.back() != dest)
+				throw std::invalid_argument("no path");
+			if(!exact)
+				continue;
+			double optimum = exact->length(best);
+			report.gaps.push_back(100 * (exact->length(learned) - optimum) / optimum);
+		}
+		catch(std::exception&)
+		{
+			++report.failed;
+		}
+	}
+}
+
+/**
+ * Measures the queries per second of a parallel batch of random pairs.
+ */
+void throughput(LaSystem& la, const std::vector<int>& ids, const Options& options, Report& report)
+{
+	SplitMix64 gen(~options.seed);
+	std::vector<std::pair<int, int>> batch(options.queries);
+	for(auto& query : batch)
+		query = {ids[gen() % ids.size()], ids[gen() % ids.size()]};
+
+	report.threads = (options.threads > 0) ? options.threads 
+			: static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+	la.setThreads(report.threads);
+	auto start = std::chrono::steady_clock::now();
+	la.paths(batch);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	report.throughput = batch.empty() ? 0 : batch.size() / elapsed.count();
+}
+
+std::vector<Field> fields(const Report& report)
+{
+	auto exact = std::count_if(report.gaps.cbegin(), report.gaps.cend(), [](double gap) { return gap < 1e-9; });
+	return {
+		{"nodes", "nodes", static_cast<double>(report.nodes), 0},
+		{"links", "links", static_cast<double>(report.links), 0},
+		{"build(ms)", "build_ms", report.buildTime, 1},
+		{"B/node", "bytes_per_node", report.nodes ? static_cast<double>(report.bytes) / report.nodes : 0, 0},
+		{"B/link", "bytes_per_link", report.links ? static_cast<double>(report.bytes) / report.links : 0, 0},
+		{"queries", "queries", static_cast<double>(report.latencies.size()), 0},
+		{"p50(us)", "p50_us", percentile(report.latencies, 0.5), 1},
+		{"p90(us)", "p90_us", percentile(report.latencies, 0.9), 1},
+		{"p99(us)", "p99_us", percentile(report.latencies, 0.99), 1},
+		{"max(us)", "max_us", percentile(report.latencies, 1), 1},
+		{"exact(us)", "exact_us", percentile(report.exactLatencies, 0.5), 1},
+		{"iters", "iterations", mean(report.iterations), 1},
+		{"max-it", "max_iterations", percentile(report.iterations, 1), 0},
+		{"gap%", "gap_pct", mean(report.gaps), 1},
+		{"max%", "max_gap_pct", percentile(report.gaps, 1), 1},
+		{"exact%", "exact_pct", report.gaps.empty() ? 0.0 : 100.0 * exact / report.gaps.size(), 1},
+		{"failed", "failed", static_cast<double>(report.failed), 0},
+		{"walkers", "walkers", static_cast<double>(report.walkers), 0},
+		{"threads", "threads", static_cast<double>(report.threads), 0},
+		{"q/s", "queries_per_s", report.throughput, 0}
+	};
+}
+
+void printHeader(const Options& options)
+{
+	if(options.format == "json")
+		return;
+
+	if(options.format == "csv")
+		std::cout << "topology";
+	else
+		std::cout << std::setw(11) << "topology";
+	for(const auto& field : fields(Report()))
+		if(options.format == "csv")
+			std::cout << ',' << field.key;
+		else
+			std::cout << std::setw(std::max<int>(std::strlen(field.heading) + 1, 9)) << field.heading;
+	std::cout << std::endl;
+}
+
+void print(const Report& report, const Options& options)
+{
+	if(options.format == "json")
+		std::cout << "{\"topology\": \"" << report.topology << '"';
+	else if(options.format == "csv")
+		std::cout << report.topology;
+	else
+		std::cout << std::setw(11) << report.topology;
+	for(const auto& field : fields(report))
+	{
+		std::cout << std::fixed << std::setprecision(field.precision);
+		if(options.format == "json")
+			std::cout << ", \"" << field.key << "\": " << field.value;
+		else if(options.format == "csv")
+			std::cout << ',' << field.value;
+		else
+			std::cout << std::setw(std::max<int>(std::strlen(field.heading) + 1, 9)) << field.value;
+	}
+	if(options.format == "json")
+		std::cout << '}';
+	std::cout << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	try
+	{
+		if(!parse(argc, argv, options))
+		{
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	catch(std::exception&)
+	{
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	LaSystem::Convergence criteria;
+	criteria.stableIterations = options.stable;
+	criteria.probability = options.probability;
+	printHeader(options);
+	auto bench = [&options, &criteria](const std::vector<AdaptiveSystem::Edge>& links, 
+			LaSystem& la, Report& report)
+			{
+				la.setConvergence(criteria);
+				la.setSeed(options.seed);
+				la.setAutoIterations(options.autoIterations);
+				la.setPerDestination(options.perDestination);
+				la.setWalkers(options.walkers);
+				la.setReinforcement(scheme(options));
+				if(options.feedback == "weight")
+					la.setFeedback(WeightFeedback());
+				else if(options.feedback == "latency")
+					la.setFeedback(LatencyFeedback());
+				else if(options.feedback == "energy")
+					la.setFeedback(EnergyFeedback());
+				la.setDeadline(std::chrono::nanoseconds(std::llround(options.deadline * 1000)));
+				std::vector<int> ids;
+				for(const auto& edge : links)
+					ids.push_back(edge.edgeStart);
+				std::sort(ids.begin(), ids.end());
+				ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+				if(ids.empty())
+					return;
+
+				report.nodes = static_cast<int>(ids.size());
+				report.walkers = options.walkers;
+				report.links = links.size();
+				std::unique_ptr<DijkstraSystem> exact;
+				if(options.exact)
+				{
+					exact = std::make_unique<DijkstraSystem>();
+					exact->insertEdges(links);
+				}
+				run(la, exact.get(), ids, options, report);
+				throughput(la, ids, options, report);
+				print(report, options);
+			};
+
+	// Build times cover initTopo(..) or insertEdges(..), the memory counts what the
+	// topology and its automata hold afterwards, scratch state excluded
+	using Clock = std::chrono::steady_clock;
+	if(!options.topology.empty())
+	{
+		// The baseline reads the same file, the links are collected for it
+		std::vector<AdaptiveSystem::Edge> links;
+		std::ifstream file(options.topology, std::ios::binary);
+		if(!file)
+		{
+			std::cerr << "Cannot open " << options.topology << std::endl;
+			return EXIT_FAILURE;
+		}
+		TopologyReader(file).read([&links](int src, int dest, double length)
+				{
+					AdaptiveSystem::Edge edge;
+					edge.edgeStart = src;
+					edge.edgeEnd = dest;
+					edge.weight = length;
+					links.push_back(edge);
+				});
+		CountingResource memory;
+		Report report;
+		report.topology = "file";
+		auto start = Clock::now();
+		LaSystem la(options.topology, options.iterations, &memory);
+		report.buildTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		report.bytes = memory.live.load();
+		bench(links, la, report);
+		return EXIT_SUCCESS;
+	}
+
+	for(const auto& kind : options.generators)
+		for(int nodes : options.sizes)
+		{
+			auto links = generate(kind, nodes, options);
+			CountingResource memory;
+			Report report;
+			report.topology = kind;
+			LaSystem la(options.iterations, &memory);
+			auto start = Clock::now();
+			la.insertEdges(links);
+			report.buildTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+			report.bytes = memory.live.load();
+			bench(links, la, report);
+		}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,257 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#include "dijkstrasystem.h"
+#include <queue>
+#include <limits>
+#include <iostream>
+#include <functional>
+#include <utility>
+#include <cstdint>
+
+/**
+ * Constructor for the DijkstraSystem.
+ *
+ * @param filename The JSON filename containing the physical topology
+ */
+DijkstraSystem::DijkstraSystem(const std::string& filename)
+{
+	adjacencyDirty = false;
+	try
+	{
+		initTopo(filename);
+	}
+	catch(std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+	}
+}
+
+/**
+ * Constructor for an empty DijkstraSystem.
+ */
+DijkstraSystem::DijkstraSystem()
+{
+	adjacencyDirty = false;
+}
+
+/**
+ * Empty destructor.
+ */
+DijkstraSystem::~DijkstraSystem() { }
+
+/**
+ * Finds the exact shortest path with Dijkstra's algorithm on a binary heap. It
+ * serves as the baseline the learned paths of LaSystem are compared against.
+ *
+ * @param src Starting node
+ * @param dest Ending node
+ * @return std::vector<int> The shortest path, empty if dest is unreachable
+ */
+std::vector<int> DijkstraSystem::path(int src, int dest)
+{
+	refresh();
+	std::vector<int> nodePath;
+	int from = denseId(src), to = denseId(dest);
+	if(from < 0 || to < 0)
+		return nodePath;
+
+	using Entry = std::pair<double, int>;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> frontier;
+	distances.assign(externalIds.size(), std::numeric_limits<double>::infinity());
+	previous.assign(externalIds.size(), -1);
+	distances[from] = 0;
+	frontier.emplace(0, from);
+	while(!frontier.empty())
+	{
+		auto [distance, node] = frontier.top();
+		frontier.pop();
+		if(node == to)
+			break;
+		if(distance > distances[node])
+			continue;
+
+		auto neighs = adjacency.neighbours(node);
+		auto weights = adjacency.weights(node);
+		for(std::size_t i = 0; i < neighs.size(); ++i)
+			if(distance + weights[i] < distances[neighs[i]])
+			{
+				distances[neighs[i]] = distance + weights[i];
+				previous[neighs[i]] = node;
+				frontier.emplace(distances[neighs[i]], neighs[i]);
+			}
+	}
+
+	if(from == to || previous[to] < 0)
+		return nodePath;
+	for(int node = to; node >= 0; node = previous[node])
+		nodePath.push_back(externalIds[node]);
+	std::reverse(nodePath.begin(), nodePath.end());
+
+	return nodePath;
+}
+
+/**
+ * Calculates the length of a path with the weights path(..) minimises, i.e.,
+ * parallel edges summed, as in LaSystem.
+ *
+ * @param nodePath The path to be evaluated
+ * @return double The path's length
+ * @throws std::invalid_argument Empty path or non-existent link
+ */
+double DijkstraSystem::length(const std::vector<int>& nodePath) noexcept(false)
+{
+	refresh();
+	if(nodePath.size() <= 1)
+		throw std::invalid_argument("DijkstraSystem::length(..): No suitable path");
+
+	double weightSum = 0;
+	for(std::size_t i = 0; i + 1 < nodePath.size(); ++i)
+	{
+		int from = denseId(nodePath[i]), to = denseId(nodePath[i + 1]);
+		if(from < 0 || to < 0)
+			throw std::invalid_argument("DijkstraSystem::length(..): Non-existent link");
+		try
+		{
+			weightSum += adjacency.weight(from, to);
+		}
+		catch(std::invalid_argument&)
+		{
+			throw std::invalid_argument("DijkstraSystem::length(..): Non-existent link");
+		}
+	}
+
+	return weightSum;
+}
+
+/**
+ * Inserts a new edge.
+ *
+ * @param src Edge's startpoint
+ * @param dest Edge's endpoint
+ * @param weight Edge's weight
+ */
+void DijkstraSystem::insertEdge(int src, int dest, double weight) noexcept(false)
+{
+	AdaptiveSystem::insertEdge(src, dest, weight);
+	adjacencyDirty = true;
+}
+
+/**
+ * Inserts a batch of edges.
+ *
+ * @param batch The edges to be inserted
+ */
+void DijkstraSystem::insertEdges(std::span<const Edge> batch) noexcept(false)
+{
+	AdaptiveSystem::insertEdges(batch);
+	adjacencyDirty = true;
+}
+
+/**
+ * Removes all edges between two nodes.
+ *
+ * @param src Edge's startpoint
+ * @param dest Edge's endpoint
+ * @throws std::invalid_argument Non-existent edge
+ */
+void DijkstraSystem::removeEdge(int src, int dest) noexcept(false)
+{
+	AdaptiveSystem::removeEdge(src, dest);
+	adjacencyDirty = true;
+}
+
+/**
+ * Changes the weight of all edges between two nodes.
+ *
+ * @param src Edge's startpoint
+ * @param dest Edge's endpoint
+ * @param weight The new weight
+ * @throws std::invalid_argument Non-existent edge
+ */
+void DijkstraSystem::updateWeight(int src, int dest, double weight) noexcept(false)
+{
+	AdaptiveSystem::updateWeight(src, dest, weight);
+	adjacencyDirty = true;
+}
+
+/**
+ * Rebuilds the numbering and the adjacency after topology changes. Parallel
+ * edges become one link weighing their sum, which is how LaSystem evaluates
+ * paths, so both systems minimise the same lengths.
+ */
+void DijkstraSystem::refresh()
+{
+	if(!adjacencyDirty)
+		return;
+
+	denseIds.clear();
+	externalIds.clear();
+	std::vector<Edge> links;
+	std::unordered_map<std::uint64_t, std::size_t> positions;
+	for(Edge link : edges)
+	{
+		for(int* node : {&link.edgeStart, &link.edgeEnd})
+		{
+			auto [it, created] = denseIds.try_emplace(*node, static_cast<int>(externalIds.size()));
+			if(created)
+				externalIds.push_back(*node);
+			*node = it->second;
+		}
+
+		std::uint64_t key = (static_cast<std::uint64_t>(link.edgeStart) << 32) 
+				| static_cast<std::uint32_t>(link.edgeEnd);
+		auto [it, created] = positions.try_emplace(key, links.size());
+		if(created)
+			links.push_back(link);
+		else
+			links[it->second].weight += link.weight;
+	}
+	adjacency.build(links, static_cast<int>(externalIds.size()));
+	adjacencyDirty = false;
+}
+
+/**
+ * Translates an external node id.
+ *
+ * @param node The external node id
+ * @return int The dense node id, negative if the node is unknown
+ */
+int DijkstraSystem::denseId(int node) const
+{
+	auto it = denseIds.find(node);
+	return (it != denseIds.end()) ? it->second : -1;
+}
+
+/**
+ * Clears instance's state
+ */
+void DijkstraSystem::clear()
+{
+	edges.clear();
+	adjacency.clear();
+	adjacencyDirty = false;
+	denseIds.clear();
+	externalIds.clear();
+}
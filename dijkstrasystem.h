@@ -0,0 +1,62 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#ifndef DIJKSTRASYSTEM_H
+#define DIJKSTRASYSTEM_H
+
+#include "adaptivesystem.h"
+#include "adjacency.h"
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <span>
+
+class DijkstraSystem : public AdaptiveSystem
+{
+public:
+	DijkstraSystem(const std::string&);
+	DijkstraSystem();
+	virtual ~DijkstraSystem();
+	virtual std::vector<int> path(int, int);
+	virtual void insertEdge(int, int, double) noexcept(false);
+	virtual void insertEdges(std::span<const Edge>) noexcept(false);
+	virtual void removeEdge(int, int) noexcept(false);
+	virtual void updateWeight(int, int, double) noexcept(false);
+	virtual void clear();
+	double length(const std::vector<int>&) noexcept(false);
+
+private:
+	void refresh();
+	int denseId(int) const;
+	Adjacency adjacency;
+	bool adjacencyDirty;
+	// Dense numbering of the nodes, as in LaSystem
+	std::unordered_map<int, int> denseIds;
+	std::vector<int> externalIds;
+	// Scratch state of a query
+	std::vector<double> distances;
+	std::vector<int> previous;
+};
+
+#endif // DIJKSTRASYSTEM_H
@@ -0,0 +1,121 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#ifndef FEEDBACK_H
+#define FEEDBACK_H
+
+/**
+ * Feedback policies of LaSystem. A policy defines the cost by which the best path
+ * of a query is chosen and the reward, in range [0,1], which trains the LAs along
+ * a valid walk. LaSystem specialises its iterations for every policy, so both
+ * calls are inlined. A policy needs two const members:
+ *
+ *   double cost(double length, int hops) const;
+ *   double reward(double cost, double bestCost, int hops, int nodes) const;
+ *
+ * where length is the sum of the walk's weights, hops its number of links,
+ * bestCost the lowest cost found by the query so far and nodes the size of
+ * the topology.
+ */
+
+/**
+ * The original policy: the best path has the lowest weight, but walks are
+ * rewarded by their hop count only, so the LAs converge to few-hop paths.
+ */
+struct HopFeedback
+{
+	double cost(double length, int) const
+	{
+		return length;
+	}
+
+	double reward(double, double, int hops, int nodes) const
+	{
+		return 1 - (hops + 1) / static_cast<double>(nodes);
+	}
+};
+
+/**
+ * Reward of the policies below: a walk's cost relative to the best path found so
+ * far, 1 for a walk as good as the best one.
+ */
+struct RelativeReward
+{
+	double reward(double cost, double bestCost, int, int) const
+	{
+		return (cost > 0) ? bestCost / cost : 1;
+	}
+};
+
+/**
+ * Rewards walks by their weight relative to the best path found so far, so the
+ * LAs converge to low-weight paths.
+ */
+struct WeightFeedback : RelativeReward
+{
+	double cost(double length, int) const
+	{
+		return length;
+	}
+};
+
+/**
+ * Rewards walks by their latency relative to the best path found so far. The
+ * latency adds the propagation delay of the weights to a processing delay per hop.
+ * The defaults are in microseconds for weights in kilometres of fibre and a
+ * router's forwarding and queueing delay, so an extra hop costs as much as 4 km.
+ */
+struct LatencyFeedback : RelativeReward
+{
+	// Delay per unit of weight
+	double propagation = 5;
+	// Delay of every hop
+	double processing = 20;
+
+	double cost(double length, int hops) const
+	{
+		return propagation * length + processing * hops;
+	}
+};
+
+/**
+ * Rewards walks by their energy relative to the best path found so far. Links
+ * consume in proportion to their weight, e.g., optical amplifiers every so many
+ * kilometres, and every node along the path adds a fixed amount. By default a
+ * node consumes as much as 50 units of weight, so the LAs trade length for hops.
+ */
+struct EnergyFeedback : RelativeReward
+{
+	// Energy per unit of weight
+	double perLength = 1;
+	// Energy of every node traversed, including the endpoints
+	double perNode = 50;
+
+	double cost(double length, int hops) const
+	{
+		return perLength * length + perNode * (hops + 1);
+	}
+};
+
+#endif // FEEDBACK_H
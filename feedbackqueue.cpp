@@ -0,0 +1,90 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#include "feedbackqueue.h"
+#include <algorithm>
+#include <bit>
+
+/**
+ * Constructor for the queue.
+ *
+ * @param capacity The most queued measurements, rounded up to a power of two
+ */
+FeedbackQueue::FeedbackQueue(std::size_t capacity)
+{
+	std::size_t size = std::bit_ceil(std::max<std::size_t>(capacity, 2));
+	slots = std::make_unique<Slot[]>(size);
+	for(std::size_t i = 0; i < size; ++i)
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+	mask = size - 1;
+	tail.store(0, std::memory_order_relaxed);
+	head = 0;
+}
+
+/**
+ * Empty destructor.
+ */
+FeedbackQueue::~FeedbackQueue() { }
+
+/**
+ * Returns the most measurements that can be queued.
+ *
+ * @return std::size_t The capacity
+ */
+std::size_t FeedbackQueue::capacity() const
+{
+	return mask + 1;
+}
+
+/**
+ * Queues a measurement. Safe to call from any number of threads.
+ *
+ * @param path The measured path
+ * @param value The measurement
+ * @return bool Indication of a queued measurement, false if the queue is full
+ */
+bool FeedbackQueue::push(std::span<const int> path, double value)
+{
+	std::size_t position = tail.load(std::memory_order_relaxed);
+	for(;;)
+	{
+		Slot& slot = slots[position & mask];
+		std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+		if(sequence == position)
+		{
+			if(tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				slot.path.assign(path.begin(), path.end());
+				slot.value = value;
+				slot.sequence.store(position + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if(sequence < position)
+			// The slot still holds a measurement of the previous lap
+			return false;
+		else
+			position = tail.load(std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,95 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#ifndef FEEDBACKQUEUE_H
+#define FEEDBACKQUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+/**
+ * Bounded queue of path measurements with many producers and one consumer.
+ * Producers claim a slot with a single compare-and-swap and never block; a full
+ * queue rejects the measurement instead. Every slot keeps its path buffer, so
+ * reporting stops allocating once the buffers have grown to the usual lengths.
+ */
+class FeedbackQueue
+{
+public:
+	static const std::size_t DEFAULT_CAPACITY = 4096;
+	FeedbackQueue(std::size_t = DEFAULT_CAPACITY);
+	FeedbackQueue(const FeedbackQueue&) = delete;
+	FeedbackQueue& operator=(const FeedbackQueue&) = delete;
+	~FeedbackQueue();
+	std::size_t capacity() const;
+	bool push(std::span<const int>, double);
+	template<class Consumer> std::size_t drain(Consumer&&, std::size_t = 0);
+
+private:
+	struct Slot
+	{
+		// Position the slot may be written at, or that position plus one once written
+		std::atomic<std::size_t> sequence;
+		std::vector<int> path;
+		double value;
+	};
+
+	std::unique_ptr<Slot[]> slots;
+	std::size_t mask;
+	// Apart, so producers and the consumer do not share a cache line
+	alignas(64) std::atomic<std::size_t> tail;
+	alignas(64) std::size_t head;
+};
+
+/**
+ * Hands queued measurements to a consumer, oldest first. Only one thread may
+ * drain at a time.
+ *
+ * @param consumer Callable receiving the path as std::span<const int> and the value
+ * @param max The most measurements to be drained, zero for all queued ones
+ * @return std::size_t The number of measurements drained
+ */
+template<class Consumer> std::size_t FeedbackQueue::drain(Consumer&& consumer, std::size_t max)
+{
+	std::size_t drained = 0;
+	while(max == 0 || drained < max)
+	{
+		Slot& slot = slots[head & mask];
+		if(slot.sequence.load(std::memory_order_acquire) != head + 1)
+			break;
+
+		consumer(std::span<const int>(slot.path), slot.value);
+		// The slot becomes writable for the position one lap ahead
+		slot.sequence.store(head + mask + 1, std::memory_order_release);
+		++head;
+		++drained;
+	}
+
+	return drained;
+}
+
+#endif // FEEDBACKQUEUE_H
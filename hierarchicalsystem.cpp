@@ -0,0 +1,887 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#include "hierarchicalsystem.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+/**
+ * Constructor for the hierarchical system.
+ *
+ * @param filename The JSON filename containing the physical topology
+ * @param iterations The number of iterations of every region's system
+ */
+HierarchicalSystem::HierarchicalSystem(const std::string& filename, int iterations)
+{
+	dirty = false;
+	this->iterations = iterations;
+	regionSize = 0;
+	try
+	{
+		initTopo(filename);
+	}
+	catch(std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+	}
+}
+
+/**
+ * Constructor for the hierarchical system.
+ *
+ * @param iterations The number of iterations of every region's system
+ */
+HierarchicalSystem::HierarchicalSystem(int iterations)
+{
+	dirty = false;
+	this->iterations = iterations;
+	regionSize = 0;
+}
+
+/**
+ * Empty destructor.
+ */
+HierarchicalSystem::~HierarchicalSystem() { }
+
+
+/**
+ * Finds a path in two levels. The system of the region graph learns which
+ * regions to cross, then every region's system learns the way from where the
+ * path enters it to the gateway link towards the next region. Walks stay inside
+ * small graphs, so the cost of convergence follows the size of the regions
+ * instead of the whole topology. Of the region paths the upper level evaluated,
+ * the ones with the cheapest estimate over the link weights are tried first; see
+ * costsToGo(..). Nodes of one region that its own links cannot connect are
+ * joined through a neighbouring region.
+ *
+ * @param src Starting node
+ * @param dest Ending node
+ * @return std::vector<int> The stitched path, empty for unknown nodes or if no
+ *         path was found
+ */
+std::vector<int> HierarchicalSystem::path(int src, int dest)
+{
+	refresh();
+	int from = regionOf(src), to = regionOf(dest);
+	if(from == NO_REGION || to == NO_REGION)
+		return {};
+
+	std::vector<std::vector<int>> regionPaths;
+	if(from != to)
+		regionPaths = outer->kPaths(from, to, REGION_PATHS);
+	else
+	{
+		std::vector<int> inside = inner[from]->path(src, dest);
+		if(!inside.empty() || src == dest)
+			return inside;
+
+		// Leave the region towards its closest neighbours and come back
+		std::vector<int> neighbours = adjacentRegions[from];
+		auto cheapest = [this, from](int region) { return gateways[keyOf(from, region)].front().weight; };
+		std::stable_sort(neighbours.begin(), neighbours.end(), 
+				[&cheapest](int lhs, int rhs) { return cheapest(lhs) < cheapest(rhs); });
+		neighbours.resize(std::min<std::size_t>(neighbours.size(), REGION_PATHS));
+		for(int neighbour : neighbours)
+		{
+			regionPaths.push_back(outer->path(neighbour, from));
+			regionPaths.back().insert(regionPaths.back().begin(), from);
+		}
+	}
+
+	// Region paths are tried in the order of their estimated cost
+	std::vector<std::vector<Distances>> toGo;
+	std::vector<std::pair<double, std::size_t>> order;
+	for(const auto& regionPath : regionPaths)
+	{
+		double cost = std::numeric_limits<double>::infinity();
+		toGo.emplace_back();
+		if(regionPath.size() > 1)
+		{
+			toGo.back() = costsToGo(src, dest, regionPath);
+			auto it = toGo.back().front().find(src);
+			if(it != toGo.back().front().end())
+				cost = it->second;
+		}
+		order.emplace_back(cost, order.size());
+	}
+	std::stable_sort(order.begin(), order.end());
+	for(const auto& [cost, i] : order)
+	{
+		if(cost == std::numeric_limits<double>::infinity())
+			break;
+		std::vector<int> stitched = stitch(src, dest, regionPaths[i], toGo[i]);
+		if(!stitched.empty())
+			return stitched;
+	}
+
+	return {};
+}
+
+/**
+ * Stitches a path along a sequence of regions. At every crossing the gateways are
+ * ranked by the cost of the whole remaining path through them; see rank(..). If
+ * a region cannot reach any of them, the previous region is left through another
+ * one.
+ *
+ * @param src Starting node
+ * @param dest Ending node
+ * @param regionPath The regions to be crossed, from the source's to the destination's
+ * @param toGo The cost to the destination from the nodes of every region on the path
+ * @return std::vector<int> The stitched path, empty if none was found
+ */
+std::vector<int> HierarchicalSystem::stitch(int src, int dest, const std::vector<int>& regionPath, 
+		const std::vector<Distances>& toGo)
+{
+	std::vector<int> stitched{src};
+	// Appends the way inside a region, nothing if the path is already at the exit
+	auto cross = [this, &stitched](int region, int exit)
+			{
+				if(stitched.back() == exit)
+					return true;
+				std::vector<int> inside = inner[region]->path(stitched.back(), exit);
+				if(inside.empty())
+					return false;
+				stitched.insert(stitched.end(), inside.cbegin() + 1, inside.cend());
+				return true;
+			};
+
+	// Depth-first over the gateway of every crossing: a region that cannot reach any
+	// gateway sends the search back, so the previous region is left elsewhere
+	std::size_t crossings = regionPath.size() - 1, i = 0;
+	std::vector<std::size_t> choice(crossings + 1, 0), entered(crossings + 1, 1);
+	std::vector<std::vector<Edge>> ranked(crossings);
+	ranked[0] = rank(src, regionPath[0], regionPath[1], toGo[1]);
+	for(int attempts = 0; attempts < ATTEMPTS_PER_REGION * static_cast<int>(regionPath.size()); ++attempts)
+	{
+		stitched.resize(entered[i]);
+		if(i == crossings)
+		{
+			if(cross(regionPath[i], dest))
+			{
+				removeLoops(stitched);
+				return stitched;
+			}
+		}
+		else if(choice[i] < ranked[i].size())
+		{
+			const Edge& link = ranked[i][choice[i]];
+			if(cross(regionPath[i], link.edgeStart))
+			{
+				stitched.push_back(link.edgeEnd);
+				entered[++i] = stitched.size();
+				choice[i] = 0;
+				if(i < crossings)
+					ranked[i] = rank(link.edgeEnd, regionPath[i], regionPath[i + 1], toGo[i + 1]);
+			}
+			else
+				++choice[i];
+			continue;
+		}
+
+		// Every gateway of this crossing failed, or the last region did
+		if(i == 0)
+			break;
+		++choice[--i];
+	}
+
+	return {};
+}
+
+/**
+ * Calculates, backwards along a sequence of regions, the cost to the destination
+ * from where the path may enter each region: inside the last region over its
+ * links, inside the others over their links to a gateway, plus the gateway, plus
+ * the cost from where the gateway enters the next region. Only the source and the
+ * gateway endpoints are evaluated, from the cached costs of every region; see
+ * bordersOf(..). These are the weights of the links, not of the learned paths, so
+ * they serve as estimates for ranking the gateways.
+ *
+ * @param src Starting node
+ * @param dest Ending node
+ * @param regionPath The regions to be crossed
+ * @return std::vector<Distances> The costs of the entries of every region, the
+ *         source's for the first one
+ */
+std::vector<HierarchicalSystem::Distances> HierarchicalSystem::costsToGo(int src, int dest, 
+		const std::vector<int>& regionPath)
+{
+	std::vector<Distances> toGo(regionPath.size());
+	auto entries = [this, src, &regionPath](std::size_t i)
+			{
+				std::vector<int> nodes;
+				if(i == 0)
+					nodes.push_back(src);
+				else
+					for(const auto& link : gateways[keyOf(regionPath[i - 1], regionPath[i])])
+						nodes.push_back(link.edgeEnd);
+				return nodes;
+			};
+
+	std::size_t last = regionPath.size() - 1;
+	for(int entry : entries(last))
+	{
+		double cost = costOf(bordersOf(regionPath[last], entry, false), dest);
+		if(cost < std::numeric_limits<double>::infinity())
+			toGo[last][entry] = cost;
+	}
+	for(std::size_t i = last; i-- > 0; )
+	{
+		const auto& links = gateways[keyOf(regionPath[i], regionPath[i + 1])];
+		for(int entry : entries(i))
+		{
+			double best = std::numeric_limits<double>::infinity();
+			for(const auto& link : links)
+			{
+				auto onwards = toGo[i + 1].find(link.edgeEnd);
+				if(onwards != toGo[i + 1].end())
+				{
+					const Distances& towards = bordersOf(regionPath[i], link.edgeStart, true);
+					best = std::min(best, costOf(towards, entry) + link.weight + onwards->second);
+				}
+			}
+			if(best < std::numeric_limits<double>::infinity())
+				toGo[i][entry] = best;
+		}
+	}
+
+	return toGo;
+}
+
+/**
+ * Ranks the gateways between two regions by the cost of the path through them:
+ * from the node where the path entered the region to the gateway, the gateway
+ * itself, and from its endpoint onwards to the destination. Gateways that cannot
+ * be reached or do not lead on are left out.
+ *
+ * @param entry The node where the path entered the region
+ * @param region The region
+ * @param next The region the gateways lead to
+ * @param onwards The cost to the destination from the entries of the next region
+ * @return std::vector<Edge> At most MAX_GATEWAYS gateways, cheapest first
+ */
+std::vector<AdaptiveSystem::Edge> HierarchicalSystem::rank(int entry, int region, int next, 
+		const Distances& onwards)
+{
+	std::vector<std::pair<double, Edge>> ranking;
+	for(const auto& link : gateways[keyOf(region, next)])
+	{
+		double to = costOf(bordersOf(region, link.edgeStart, true), entry);
+		auto from = onwards.find(link.edgeEnd);
+		if(to < std::numeric_limits<double>::infinity() && from != onwards.end())
+			ranking.emplace_back(to + link.weight + from->second, link);
+	}
+	std::stable_sort(ranking.begin(), ranking.end(), 
+			[](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+	std::vector<Edge> ranked;
+	for(std::size_t i = 0; i < ranking.size() && i < MAX_GATEWAYS; ++i)
+		ranked.push_back(ranking[i].second);
+
+	return ranked;
+}
+
+/**
+ * Returns the cached costs of a region between one gateway endpoint and all of
+ * its nodes, building them on first use. They stay until the region's links
+ * change, so repeated queries only look them up.
+ *
+ * @param region The region
+ * @param border The gateway endpoint
+ * @param towards True for the costs towards the endpoint, false for those from it
+ * @return const Distances& The cost of every node of the region it connects to
+ */
+const HierarchicalSystem::Distances& HierarchicalSystem::bordersOf(int region, int border, 
+		bool towards)
+{
+	auto& table = towards ? borders[region].to : borders[region].from;
+	auto [it, created] = table.try_emplace(border);
+	if(created)
+	{
+		// Links inside regions only, so the search stays in the region of the endpoint
+		std::pair<int, double> source{border, 0.0};
+		it->second = distances(std::span(&source, 1), towards ? incoming : outgoing);
+	}
+
+	return it->second;
+}
+
+/**
+ * Looks up the cost of a node.
+ *
+ * @param costs The costs of the reached nodes
+ * @param node The node
+ * @return double The cost, infinity if the node is not reached
+ */
+double HierarchicalSystem::costOf(const Distances& costs, int node)
+{
+	auto cost = costs.find(node);
+
+	return (cost == costs.end()) ? std::numeric_limits<double>::infinity() : cost->second;
+}
+
+/**
+ * Finds the cheapest costs from a set of sources with Dijkstra's algorithm.
+ *
+ * @param sources The sources and their initial costs
+ * @param links The links to be followed, incoming ones for costs towards the sources
+ * @return Distances The cost of every reached node
+ */
+HierarchicalSystem::Distances HierarchicalSystem::distances(
+		std::span<const std::pair<int, double>> sources, const Links& links)
+{
+	using Entry = std::pair<double, int>;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> frontier;
+	Distances result;
+	auto relax = [&result, &frontier](int node, double cost)
+			{
+				auto [it, created] = result.try_emplace(node, cost);
+				if(created || cost < it->second)
+				{
+					it->second = cost;
+					frontier.emplace(cost, node);
+				}
+			};
+
+	for(const auto& [node, cost] : sources)
+		relax(node, cost);
+	while(!frontier.empty())
+	{
+		auto [cost, node] = frontier.top();
+		frontier.pop();
+		if(cost > result[node])
+			continue;
+
+		auto it = links.find(node);
+		if(it != links.end())
+			for(const auto& [neighbour, weight] : it->second)
+				relax(neighbour, cost + weight);
+	}
+
+	return result;
+}
+
+/**
+ * Cuts the loops out of a path. A path that leaves a region and comes back may
+ * pass a node twice.
+ *
+ * @param nodePath The path
+ */
+void HierarchicalSystem::removeLoops(std::vector<int>& nodePath)
+{
+	std::unordered_map<int, std::size_t> positions;
+	std::size_t length = 0;
+	for(int node : nodePath)
+	{
+		auto [it, created] = positions.try_emplace(node, length);
+		if(created)
+			nodePath[length++] = node;
+		else
+		{
+			// Back to where the node was first passed
+			for(std::size_t i = it->second + 1; i < length; ++i)
+				positions.erase(nodePath[i]);
+			length = it->second + 1;
+		}
+	}
+	nodePath.resize(length);
+}
+
+/**
+ * Inserts an edge. Once the regions are built, the edge is passed to its region's
+ * system, or becomes a gateway of the region graph, so the learned automata are
+ * kept; a new node joins the region of its neighbour, two new nodes form a new
+ * region. Until then the regions are built by the next query.
+ *
+ * @param src The starting node
+ * @param dest The ending node
+ * @param weight The weight of the edge
+ */
+void HierarchicalSystem::insertEdge(int src, int dest, double weight) noexcept(false)
+{
+	AdaptiveSystem::insertEdge(src, dest, weight);
+	if(dirty || !outer)
+		dirty = true;
+	else
+		link(edges.back());
+}
+
+/**
+ * Inserts a batch of edges, passed on one by one like insertEdge(..) once the
+ * regions are built.
+ *
+ * @param batch The edges to be inserted
+ */
+void HierarchicalSystem::insertEdges(std::span<const Edge> batch) noexcept(false)
+{
+	AdaptiveSystem::insertEdges(batch);
+	if(dirty || !outer)
+		dirty = true;
+	else
+		for(std::size_t i = edges.size() - batch.size(); i < edges.size(); ++i)
+			link(edges[i]);
+}
+
+/**
+ * Removes all edges between two nodes. Once the regions are built, the removal
+ * is passed to the region's system, or to the region graph for a gateway link,
+ * so the regions stay as they are and the learned automata are kept.
+ *
+ * @param src The starting node
+ * @param dest The ending node
+ */
+void HierarchicalSystem::removeEdge(int src, int dest) noexcept(false)
+{
+	AdaptiveSystem::removeEdge(src, dest);
+	if(dirty || !outer)
+	{
+		dirty = true;
+		return;
+	}
+
+	int from = regionIds[src], to = regionIds[dest];
+	borders[from] = Borders();
+	borders[to] = Borders();
+	if(from == to)
+	{
+		inner[from]->removeEdge(src, dest);
+		std::erase_if(outgoing[src], [dest](const auto& link) { return link.first == dest; });
+		std::erase_if(incoming[dest], [src](const auto& link) { return link.first == src; });
+		return;
+	}
+
+	auto& links = gateways[keyOf(from, to)];
+	std::erase_if(links, [src, dest](const Edge& link) { return link.edgeStart == src && link.edgeEnd == dest; });
+	if(!links.empty())
+	{
+		outer->updateWeight(from, to, links.front().weight);
+		return;
+	}
+	gateways.erase(keyOf(from, to));
+	std::erase(adjacentRegions[from], to);
+	outer->removeEdge(from, to);
+}
+
+/**
+ * Changes the weight of all edges between two nodes. The regions stay as they
+ * are: the change is passed to the region's system, or to the region graph for
+ * a gateway link, so the learned automata are kept.
+ *
+ * @param src The starting node
+ * @param dest The ending node
+ * @param weight The new weight
+ */
+void HierarchicalSystem::updateWeight(int src, int dest, double weight) noexcept(false)
+{
+	AdaptiveSystem::updateWeight(src, dest, weight);
+	if(dirty)
+		return;
+
+	double sum = summedWeight(src, dest);
+	int from = regionOf(src), to = regionOf(dest);
+	if(from == to)
+	{
+		inner[from]->updateWeight(src, dest, weight);
+		setCost(outgoing, src, dest, sum);
+		setCost(incoming, dest, src, sum);
+		borders[from] = Borders();
+		return;
+	}
+
+	// The region graph links two regions with their cheapest gateway
+	auto& links = gateways[keyOf(from, to)];
+	for(auto& link : links)
+		if(link.edgeStart == src && link.edgeEnd == dest)
+			link.weight = sum;
+	std::stable_sort(links.begin(), links.end(), 
+			[](const Edge& lhs, const Edge& rhs) { return lhs.weight < rhs.weight; });
+	outer->updateWeight(from, to, links.front().weight);
+}
+
+/**
+ * Passes an inserted edge to the built regions. An edge inside a region trains
+ * its system, an edge across regions joins their gateways and, for a new pair of
+ * regions, the region graph.
+ *
+ * @param edge The edge, already part of the topology
+ */
+void HierarchicalSystem::link(const Edge& edge)
+{
+	int src = edge.edgeStart, dest = edge.edgeEnd;
+	auto known = [this](int node) { return regionIds.count(node) > 0; };
+	if(!known(src) && !known(dest))
+	{
+		// A separate component until later edges connect it
+		int region = static_cast<int>(inner.size());
+		regionIds[src] = regionIds[dest] = region;
+		inner.push_back(createSystem({}));
+		adjacentRegions.emplace_back();
+		borders.emplace_back();
+	}
+	else if(!known(src))
+		regionIds[src] = regionIds[dest];
+	else if(!known(dest))
+		regionIds[dest] = regionIds[src];
+
+	double sum = summedWeight(src, dest);
+	int from = regionIds[src], to = regionIds[dest];
+	borders[from] = Borders();
+	borders[to] = Borders();
+	if(from == to)
+	{
+		inner[from]->insertEdge(src, dest, edge.weight);
+		setCost(outgoing, src, dest, sum);
+		setCost(incoming, dest, src, sum);
+		return;
+	}
+
+	auto& links = gateways[keyOf(from, to)];
+	bool linked = !links.empty();
+	auto it = std::find_if(links.begin(), links.end(), 
+			[src, dest](const Edge& link) { return link.edgeStart == src && link.edgeEnd == dest; });
+	if(it == links.end())
+	{
+		links.push_back(edge);
+		it = links.end() - 1;
+	}
+	it->weight = sum;
+	std::stable_sort(links.begin(), links.end(), 
+			[](const Edge& lhs, const Edge& rhs) { return lhs.weight < rhs.weight; });
+	if(linked)
+		outer->updateWeight(from, to, links.front().weight);
+	else
+	{
+		auto& neighbours = adjacentRegions[from];
+		neighbours.insert(std::lower_bound(neighbours.begin(), neighbours.end(), to), to);
+		outer->insertEdge(from, to, links.front().weight);
+	}
+}
+
+/**
+ * Sums the weights of the parallel edges between two nodes, the way LaSystem
+ * merges them.
+ *
+ * @param src The starting node
+ * @param dest The ending node
+ * @return double The summed weight
+ */
+double HierarchicalSystem::summedWeight(int src, int dest) const
+{
+	double sum = 0;
+	for(const auto& edge : edges)
+		if(edge.edgeStart == src && edge.edgeEnd == dest)
+			sum += edge.weight;
+
+	return sum;
+}
+
+/**
+ * Sets the cost of a link inside a region, adding the link if needed.
+ *
+ * @param links The outgoing or incoming links
+ * @param node The node whose links are changed
+ * @param neighbour The other end of the link
+ * @param cost The summed weight of the link
+ */
+void HierarchicalSystem::setCost(Links& links, int node, int neighbour, double cost)
+{
+	auto& adjacent = links[node];
+	auto it = std::find_if(adjacent.begin(), adjacent.end(), 
+			[neighbour](const auto& link) { return link.first == neighbour; });
+	if(it == adjacent.end())
+		adjacent.emplace_back(neighbour, cost);
+	else
+		it->second = cost;
+}
+
+/**
+ * Deletes the topology and all systems.
+ */
+void HierarchicalSystem::clear()
+{
+	edges.clear();
+	regionIds.clear();
+	outer.reset();
+	inner.clear();
+	gateways.clear();
+	adjacentRegions.clear();
+	outgoing.clear();
+	incoming.clear();
+	borders.clear();
+	dirty = false;
+}
+
+/**
+ * Assigns nodes to areas, e.g., the areas of a routing protocol. Every area
+ * becomes one region; nodes without an area are partitioned automatically.
+ *
+ * @param nodeAreas The area id of every node
+ */
+void HierarchicalSystem::setAreas(const std::unordered_map<int, int>& nodeAreas)
+{
+	areas = nodeAreas;
+	dirty = true;
+}
+
+/**
+ * Sets the size of the regions that automatic partitioning grows.
+ *
+ * @param size The number of nodes per region, zero for DEFAULT_REGION_SIZE; the
+ *        automata lose accuracy in much larger regions
+ */
+void HierarchicalSystem::setRegionSize(int size)
+{
+	regionSize = std::max(size, 0);
+	dirty = true;
+}
+
+/**
+ * Sets how every underlying system is configured, e.g., its convergence
+ * criteria, seed or feedback policy. It is applied now and whenever the
+ * regions are rebuilt.
+ *
+ * @param change Applied to the region graph's system and to every region's one
+ */
+void HierarchicalSystem::configure(const std::function<void(LaSystem&)>& change)
+{
+	configuration = change;
+	if(dirty || !outer)
+		return;
+
+	configuration(*outer);
+	for(auto& system : inner)
+		configuration(*system);
+}
+
+/**
+ * Returns the number of regions.
+ *
+ * @return int The regions of the current topology
+ */
+int HierarchicalSystem::regions()
+{
+	refresh();
+	return static_cast<int>(inner.size());
+}
+
+/**
+ * Returns the region of a node.
+ *
+ * @param node The node
+ * @return int Its region, NO_REGION for unknown nodes
+ */
+int HierarchicalSystem::regionOf(int node)
+{
+	refresh();
+	auto it = regionIds.find(node);
+	return (it == regionIds.end()) ? NO_REGION : it->second;
+}
+
+/**
+ * Creates the key of a pair of regions, or of nodes.
+ *
+ * @param from The first region or node
+ * @param to The second region or node
+ * @return std::uint64_t The key
+ */
+std::uint64_t HierarchicalSystem::keyOf(int from, int to)
+{
+	return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(from)) << 32) 
+			| static_cast<std::uint32_t>(to);
+}
+
+/**
+ * Rebuilds the regions and their systems after topology changes. Links inside
+ * a region train its own system, links across regions become its gateways.
+ */
+void HierarchicalSystem::refresh()
+{
+	if(!dirty)
+		return;
+
+	dirty = false;
+	partition();
+	int count = 0;
+	for(const auto& [node, region] : regionIds)
+		count = std::max(count, region + 1);
+
+	gateways.clear();
+	outgoing.clear();
+	incoming.clear();
+	std::unordered_map<std::uint64_t, double> sums;
+	for(const auto& edge : edges)
+		sums[keyOf(edge.edgeStart, edge.edgeEnd)] += edge.weight;
+
+	std::vector<std::vector<Edge>> inside(count);
+	for(const auto& edge : edges)
+	{
+		int from = regionIds[edge.edgeStart], to = regionIds[edge.edgeEnd];
+		if(from == to)
+			inside[from].push_back(edge);
+		// Parallel edges count once, with their summed weight as in LaSystem
+		auto sum = sums.find(keyOf(edge.edgeStart, edge.edgeEnd));
+		if(sum == sums.end())
+			continue;
+		if(from == to)
+		{
+			outgoing[edge.edgeStart].emplace_back(edge.edgeEnd, sum->second);
+			incoming[edge.edgeEnd].emplace_back(edge.edgeStart, sum->second);
+		}
+		else
+		{
+			Edge link = edge;
+			link.weight = sum->second;
+			gateways[keyOf(from, to)].push_back(link);
+		}
+		sums.erase(sum);
+	}
+
+	inner.clear();
+	for(const auto& links : inside)
+		inner.push_back(createSystem(links));
+	borders.assign(count, Borders());
+
+	std::vector<Edge> regionLinks;
+	adjacentRegions.assign(count, {});
+	for(auto& [key, links] : gateways)
+	{
+		std::stable_sort(links.begin(), links.end(), 
+				[](const Edge& lhs, const Edge& rhs) { return lhs.weight < rhs.weight; });
+		Edge link;
+		link.edgeStart = static_cast<int>(key >> 32);
+		link.edgeEnd = static_cast<int>(key & 0xffffffff);
+		link.weight = links.front().weight;
+		regionLinks.push_back(link);
+		adjacentRegions[link.edgeStart].push_back(link.edgeEnd);
+	}
+	for(auto& neighbours : adjacentRegions)
+		std::sort(neighbours.begin(), neighbours.end());
+	// Independent of the hashing order, so seeded runs are reproducible
+	std::sort(regionLinks.begin(), regionLinks.end(), [](const Edge& lhs, const Edge& rhs)
+			{ return std::pair(lhs.edgeStart, lhs.edgeEnd) < std::pair(rhs.edgeStart, rhs.edgeEnd); });
+	outer = createSystem(regionLinks);
+}
+
+/**
+ * Assigns every node to a region. Areas come first; the remaining nodes form
+ * regions grown breadth-first from the lowest unassigned node, following links
+ * in either direction, so every such region is connected. Fragments below half
+ * the size join an adjacent grown region.
+ */
+void HierarchicalSystem::partition()
+{
+	std::unordered_map<int, int> dense;
+	std::vector<int> nodes;
+	for(const auto& edge : edges)
+		for(int node : {edge.edgeStart, edge.edgeEnd})
+			if(dense.try_emplace(node, static_cast<int>(nodes.size())).second)
+				nodes.push_back(node);
+
+	std::vector<std::vector<int>> neighbours(nodes.size());
+	for(const auto& edge : edges)
+	{
+		int from = dense[edge.edgeStart], to = dense[edge.edgeEnd];
+		neighbours[from].push_back(to);
+		neighbours[to].push_back(from);
+	}
+
+	std::vector<int> assigned(nodes.size(), NO_REGION);
+	std::unordered_map<int, int> areaRegions;
+	int count = 0;
+	for(std::size_t node = 0; node < nodes.size(); ++node)
+	{
+		auto area = areas.find(nodes[node]);
+		if(area == areas.end())
+			continue;
+		auto [it, created] = areaRegions.try_emplace(area->second, count);
+		if(created)
+			++count;
+		assigned[node] = it->second;
+	}
+
+	std::size_t size = (regionSize > 0) ? regionSize : DEFAULT_REGION_SIZE;
+	std::vector<int> order(nodes.size());
+	for(std::size_t node = 0; node < nodes.size(); ++node)
+		order[node] = static_cast<int>(node);
+	std::sort(order.begin(), order.end(), [&nodes](int lhs, int rhs) { return nodes[lhs] < nodes[rhs]; });
+	int firstGrown = count;
+	std::vector<int> frontier;
+	for(int seed : order)
+	{
+		if(assigned[seed] != NO_REGION)
+			continue;
+		frontier.assign(1, seed);
+		assigned[seed] = count;
+		for(std::size_t next = 0; next < frontier.size() && frontier.size() < size; ++next)
+			for(int neighbour : neighbours[frontier[next]])
+				if(assigned[neighbour] == NO_REGION && frontier.size() < size)
+				{
+					assigned[neighbour] = count;
+					frontier.push_back(neighbour);
+				}
+
+		// Fragments enclosed by earlier regions join one of them, e.g., the access
+		// nodes left behind by their aggregation node's region
+		int joined = NO_REGION;
+		if(frontier.size() < size / 2)
+			for(std::size_t member = 0; member < frontier.size() && joined == NO_REGION; ++member)
+				for(int neighbour : neighbours[frontier[member]])
+					if(assigned[neighbour] >= firstGrown && assigned[neighbour] < count)
+					{
+						joined = assigned[neighbour];
+						break;
+					}
+		if(joined == NO_REGION)
+			++count;
+		else
+			for(int member : frontier)
+				assigned[member] = joined;
+	}
+
+	regionIds.clear();
+	for(std::size_t node = 0; node < nodes.size(); ++node)
+		regionIds[nodes[node]] = assigned[node];
+}
+
+/**
+ * Region of nodes outside the topology, defined since containers bind it by reference
+ */
+const int HierarchicalSystem::NO_REGION;
+
+/**
+ * Creates a configured system over some links.
+ *
+ * @param links The links of the system
+ * @return std::unique_ptr<LaSystem> The system
+ */
+std::unique_ptr<LaSystem> HierarchicalSystem::createSystem(std::span<const Edge> links) const
+{
+	auto system = std::make_unique<LaSystem>(iterations);
+	if(configuration)
+		configuration(*system);
+	system->insertEdges(links);
+
+	return system;
+}
@@ -0,0 +1,108 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#ifndef HIERARCHICALSYSTEM_H
+#define HIERARCHICALSYSTEM_H
+
+#include "adaptivesystem.h"
+#include "lasystem.h"
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <string>
+#include <span>
+
+class HierarchicalSystem : public AdaptiveSystem
+{
+public:
+	static const int NO_REGION = -1;
+	HierarchicalSystem(const std::string&, int = 0);
+	HierarchicalSystem(int = 0);
+	virtual ~HierarchicalSystem();
+	virtual std::vector<int> path(int, int);
+	virtual void insertEdge(int, int, double) noexcept(false);
+	virtual void insertEdges(std::span<const Edge>) noexcept(false);
+	virtual void removeEdge(int, int) noexcept(false);
+	virtual void updateWeight(int, int, double) noexcept(false);
+	virtual void clear();
+	void setAreas(const std::unordered_map<int, int>&);
+	void setRegionSize(int);
+	void configure(const std::function<void(LaSystem&)>&);
+	int regions();
+	int regionOf(int);
+
+private:
+	static const std::size_t DEFAULT_REGION_SIZE = 48;
+	static const int MAX_GATEWAYS = 4;
+	static const int REGION_PATHS = 4;
+	static const int ATTEMPTS_PER_REGION = 8;
+	// Outgoing or incoming links of every node, with the neighbour and the weight
+	using Links = std::unordered_map<int, std::vector<std::pair<int, double>>>;
+	// Cost of every reached node
+	using Distances = std::unordered_map<int, double>;
+	// Costs inside a region from and to the endpoints of its gateways, over its links
+	struct Borders
+	{
+		std::unordered_map<int, Distances> from;
+		std::unordered_map<int, Distances> to;
+	};
+	static std::uint64_t keyOf(int, int);
+	std::vector<int> stitch(int, int, const std::vector<int>&, const std::vector<Distances>&);
+	std::vector<Distances> costsToGo(int, int, const std::vector<int>&);
+	std::vector<Edge> rank(int, int, int, const Distances&);
+	const Distances& bordersOf(int, int, bool);
+	static double costOf(const Distances&, int);
+	static Distances distances(std::span<const std::pair<int, double>>, const Links&);
+	static void removeLoops(std::vector<int>&);
+	void link(const Edge&);
+	double summedWeight(int, int) const;
+	static void setCost(Links&, int, int, double);
+	void refresh();
+	void partition();
+	std::unique_ptr<LaSystem> createSystem(std::span<const Edge>) const;
+	bool dirty;
+	int iterations;
+	int regionSize;
+	// Areas given by the user, the other nodes are partitioned automatically
+	std::unordered_map<int, int> areas;
+	std::function<void(LaSystem&)> configuration;
+	std::unordered_map<int, int> regionIds;
+	// Learns the sequence of regions, every region is a node of it
+	std::unique_ptr<LaSystem> outer;
+	// Learns the paths inside every region, over its internal links only
+	std::vector<std::unique_ptr<LaSystem>> inner;
+	// Links from one region to another, parallel ones summed, cheapest first
+	std::unordered_map<std::uint64_t, std::vector<Edge>> gateways;
+	// Regions that every region has gateways towards
+	std::vector<std::vector<int>> adjacentRegions;
+	// Links inside the regions, parallel ones summed, to rank the gateways with
+	Links outgoing;
+	Links incoming;
+	// Cached costs of every region, dropped when its links change
+	std::vector<Borders> borders;
+};
+
+#endif // HIERARCHICALSYSTEM_H
@@ -22,29 +22,73 @@
  */
 
 #include "lasystem.h"
+#include <cstring>
+#include <bit>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// Statistics cost one predictable branch while disabled and nothing when compiled out
+#ifdef LAPATH_STATS
+#define LAPATH_STAT(statement) do { if(statistics) { statement; } } while(false)
+#else
+#define LAPATH_STAT(statement) do { } while(false)
+#endif
+
+/**
+ * Default constructor. The generator starts from a zero seed, see reseed(..).
+ */
+LA::LA() { }
+
+/**
+ * Constructor whose arrays allocate from the given allocator's resource.
+ *
+ * @param alloc The allocator
+ */
+LA::LA(const allocator_type& alloc) 
+		: neighs(alloc), probs(alloc), lastTimes(alloc), sizes(alloc), estimates(alloc) { }
+
+/**
+ * Copy constructor towards another allocator.
+ *
+ * @param rhs The LA to be copied
+ * @param alloc The allocator of the copy
+ */
+LA::LA(const LA& rhs, const allocator_type& alloc) 
+		: neighs(rhs.neighs, alloc), probs(rhs.probs, alloc), lastTimes(rhs.lastTimes, alloc), 
+		sizes(rhs.sizes, alloc), estimates(rhs.estimates, alloc), gen(rhs.gen) { }
+
+/**
+ * Move constructor towards another allocator, which copies unless both use the
+ * same resource.
+ *
+ * @param rhs The LA to be moved
+ * @param alloc The allocator of the new LA
+ */
+LA::LA(LA&& rhs, const allocator_type& alloc) 
+		: neighs(std::move(rhs.neighs), alloc), probs(std::move(rhs.probs), alloc), 
+		lastTimes(std::move(rhs.lastTimes), alloc), sizes(std::move(rhs.sizes), alloc), 
+		estimates(std::move(rhs.estimates), alloc), gen(rhs.gen) { }
 
 /**
- * Default constructor.
+ * Constructor that uses an initializer list for LA's items.
  */
-LA::LA()
+LA::LA(std::initializer_list<int> items)
 {
-	std::random_device rd;
-	gen = std::mt19937_64(rd());
+	for(auto item : items)
+		insertItem(item);
 }
 
 /**
- * Constructor that uses an initializer list for LA's items.
+ * Restarts the generator used for breaking ties between equal costs.
+ *
+ * @param value The new seed
  */
-LA::LA(std::initializer_list<int> neighs)
+void LA::reseed(std::uint64_t value)
 {
-	for(auto neigh : neighs)
-	{
-		probs[neigh] = 1.0 / neighs.size();
-		lastTimes[neigh] = 0;
-		sizes[neigh] = 1;
-	}
-	std::random_device rd;
-	gen = std::mt19937_64(rd());
+	gen = SplitMix64(value);
 }
 
 /**
@@ -53,18 +97,116 @@ LA::LA(std::initializer_list<int> neighs)
 LA::~LA() { }
 
 /**
- * Updates all probabilities. Increases the input item and decreases all others.
- * Sum of all items before and after the increase is equal to 1. The sum of the 
- * decrease of the rest items is equal to the amount of input item's increase.
+ * Returns the position of an item inside the parallel arrays. Items are kept
+ * sorted, so a binary search is used.
+ *
+ * @param item The item to be found
+ * @return int Its position or NO_NEXT_ITEM when unknown
+ */
+int LA::indexOf(int item) const
+{
+	auto it = std::lower_bound(neighs.cbegin(), neighs.cend(), item);
+	if(it == neighs.cend() || *it != item)
+		return NO_NEXT_ITEM;
+
+	return static_cast<int>(it - neighs.cbegin());
+}
+
+/**
+ * Writes the learned state, i.e., every item with its probability, last time and
+ * reward estimate.
+ *
+ * @param out The output stream
+ * @param labels The external id of every item, which is written instead of it
+ */
+void LA::write(std::ostream& out, std::span<const int> labels) const
+{
+	auto count = static_cast<std::uint32_t>(neighs.size());
+	out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	for(std::size_t i = 0; i < neighs.size(); ++i)
+	{
+		auto item = static_cast<std::int32_t>(labels[neighs[i]]);
+		out.write(reinterpret_cast<const char*>(&item), sizeof(item));
+		out.write(reinterpret_cast<const char*>(&probs[i]), sizeof(double));
+		out.write(reinterpret_cast<const char*>(&lastTimes[i]), sizeof(double));
+		out.write(reinterpret_cast<const char*>(&estimates[i]), sizeof(double));
+	}
+}
+
+/**
+ * Restores state written by write(..). Items unknown to this LA are skipped, the
+ * others take the stored values and the probabilities are renormalised, so a
+ * checkpoint of a slightly different topology can still be used. State of the first
+ * checkpoint version has no estimates, the stored items then restart theirs.
+ *
+ * @param in The input stream
+ * @param ids Translates the stored external ids to items
+ * @param version The checkpoint version the state was written with
+ * @throws std::runtime_error Truncated input
+ */
+void LA::read(std::istream& in, const std::pmr::unordered_map<int, int>& ids, 
+		std::uint32_t version) noexcept(false)
+{
+	std::uint32_t count = 0;
+	in.read(reinterpret_cast<char*>(&count), sizeof(count));
+	for(std::uint32_t i = 0; in && i < count; ++i)
+	{
+		std::int32_t item = 0;
+		double prob = 0, time = 0, estimate = 0;
+		in.read(reinterpret_cast<char*>(&item), sizeof(item));
+		in.read(reinterpret_cast<char*>(&prob), sizeof(prob));
+		in.read(reinterpret_cast<char*>(&time), sizeof(time));
+		if(version >= 2)
+			in.read(reinterpret_cast<char*>(&estimate), sizeof(estimate));
+		auto id = ids.find(item);
+		int index = (id != ids.end()) ? indexOf(id->second) : NO_NEXT_ITEM;
+		if(in && index != NO_NEXT_ITEM)
+		{
+			probs[index] = prob;
+			lastTimes[index] = time;
+			estimates[index] = estimate;
+		}
+	}
+	if(!in)
+		throw std::runtime_error("LA::read(..): Truncated state");
+
+	double sum = 0;
+	for(double prob : probs)
+		sum += prob;
+	for(auto& prob : probs)
+		prob = (sum > 0) ? prob / sum : 1.0 / probs.size();
+}
+
+/**
+ * Updates all probabilities with Linear Reward-Inaction. Increases the input item
+ * and decreases all others. Sum of all items before and after the increase is equal
+ * to 1. The sum of the decrease of the rest items is equal to the amount of input
+ * item's increase.
  *
  * @param node Item whose probability will be increased
  * @param time Timestamp of the increase
  * @param feedback Environment's response to the item
- * @throws std::out_of_range The item is unknown to this LA
+ * @throws std::invalid_argument Non-existent node
  */
 void LA::updateProbs(int node, double time, double feedback) noexcept(false)
 {
-	if(probs.find(node) == probs.end())
+	update(node, time, feedback, RewardInaction());
+}
+
+/**
+ * Updates all probabilities with a reinforcement scheme, see reinforcement.h.
+ *
+ * @param node Item that was chosen
+ * @param time Timestamp of the update
+ * @param feedback Environment's response to the item, clamped to [0,1]
+ * @param scheme The reinforcement scheme
+ * @throws std::invalid_argument Non-existent node
+ */
+template<class Scheme> void LA::update(int node, double time, double feedback, 
+		const Scheme& scheme) noexcept(false)
+{
+	int index = indexOf(node);
+	if(index == NO_NEXT_ITEM)
 		throw std::invalid_argument("LA::updateProbs(..): Non-existent node");
 	
 	// Clamp feedback value
@@ -73,25 +215,39 @@ void LA::updateProbs(int node, double time, double feedback) noexcept(false)
 	if(feedback > 1)
 		feedback = 1;
 	
-	// Automaton parameters
-	double a = 0.0001;
-	double l = 0.15;
-	double sumPj = 0;
-	// The value of 'l' determines the convergence speed to the actual
-	// demand and 'a' makes low priority neighbours not reach zero value
-	for(auto& nodeProb : probs)
-		if(nodeProb.first != node)
-		{
-			sumPj += (probs[nodeProb.first] - a);
-			probs[nodeProb.first] = (probs[nodeProb.first] 
-					- l * feedback * (probs[nodeProb.first] - a));
-		}
+	scheme.update(probs, estimates, index, feedback);
+	lastTimes[index] = time;
+}
+
+template void LA::update(int, double, double, const RewardInaction&);
+template void LA::update(int, double, double, const RewardPenalty&);
+template void LA::update(int, double, double, const Pursuit&);
+template void LA::update(int, double, double, const Estimator&);
+
+/**
+ * Updates all probabilities with a reinforcement scheme, leaving the time the item
+ * was last selected unchanged.
+ *
+ * @param node Item that was chosen
+ * @param feedback Environment's response to the item, clamped to [0,1]
+ * @param scheme The reinforcement scheme
+ * @throws std::invalid_argument Non-existent node
+ */
+template<class Scheme> void LA::reinforce(int node, double feedback, 
+		const Scheme& scheme) noexcept(false)
+{
+	int index = indexOf(node);
+	if(index == NO_NEXT_ITEM)
+		throw std::invalid_argument("LA::reinforce(..): Non-existent node");
 	
-	// The amount that was subtracted from the other items will be added to this one
-	probs[node] = (probs[node] + l * feedback * sumPj);
-	lastTimes[node] = time;
+	scheme.update(probs, estimates, index, std::clamp(feedback, 0.0, 1.0));
 }
 
+template void LA::reinforce(int, double, const RewardInaction&);
+template void LA::reinforce(int, double, const RewardPenalty&);
+template void LA::reinforce(int, double, const Pursuit&);
+template void LA::reinforce(int, double, const Estimator&);
+
 /**
  * Updates the time the input item was last selected.
  *
@@ -101,10 +257,40 @@ void LA::updateProbs(int node, double time, double feedback) noexcept(false)
  */
 void LA::timeChange(int item, double time) noexcept(false)
 {
-	if(probs.find(item) == probs.end())
+	int index = indexOf(item);
+	if(index == NO_NEXT_ITEM)
 		throw std::invalid_argument("LA::timeChange(..): Non-existent item");
 	
-	lastTimes[item] = time;
+	lastTimes[index] = time;
+}
+
+/**
+ * Returns the current probability of an item.
+ *
+ * @param item The item
+ * @return double Its probability
+ * @throws std::invalid_argument Unknown item to this LA
+ */
+double LA::probability(int item) const noexcept(false)
+{
+	int index = indexOf(item);
+	if(index == NO_NEXT_ITEM)
+		throw std::invalid_argument("LA::probability(..): Non-existent item");
+
+	return probs[index];
+}
+
+/**
+ * Returns the item chosen with the highest probability, the lowest one on ties.
+ *
+ * @return int The item, NO_NEXT_ITEM without any items
+ */
+int LA::bestItem() const
+{
+	if(probs.empty())
+		return NO_NEXT_ITEM;
+
+	return neighs[std::max_element(probs.cbegin(), probs.cend()) - probs.cbegin()];
 }
 
 /**
@@ -114,382 +300,2286 @@ void LA::timeChange(int item, double time) noexcept(false)
  */
 std::list<int> LA::items()
 {
-	std::list<int> retItems;
-	for(auto& pair : probs)
-		retItems.push_back(pair.first);
-	
-	return retItems;
+	return std::list<int>(neighs.cbegin(), neighs.cend());
 }
 
 /**
- * Inserts a new item to this LA. Probabilities are updated to be equal.
+ * Inserts a new item to this LA. The new item gets an equal share and the
+ * probabilities of the existing items are scaled down in place, so whatever
+ * has been learned so far keeps its relative order.
  * 
  * @param node The item to be inserted
  * @param size Its size
  */
 void LA::insertItem(int node, int size)
 {
-	if(probs.find(node) != probs.end())
+	auto it = std::lower_bound(neighs.cbegin(), neighs.cend(), node);
+	if(it != neighs.cend() && *it == node)
 		return;
 	
-	lastTimes[node] = 0;
-	probs[node] = 0;
-	sizes[node] = size;
-	int items = probs.size();
-	for(auto& pair : probs)
-		pair.second = 1.0 / items;
+	double items = neighs.size() + 1;
+	for(auto& prob : probs)
+		prob *= (items - 1) / items;
+
+	auto index = it - neighs.cbegin();
+	neighs.insert(neighs.begin() + index, node);
+	probs.insert(probs.begin() + index, 1.0 / items);
+	lastTimes.insert(lastTimes.begin() + index, 0);
+	sizes.insert(sizes.begin() + index, size);
+	estimates.insert(estimates.begin() + index, 0);
+}
+
+/**
+ * Removes an item from this LA. The remaining probabilities are renormalised
+ * in place so that their sum is equal to 1.
+ *
+ * @param node The item to be removed
+ * @throws std::invalid_argument The item is unknown to this LA
+ */
+void LA::removeItem(int node) noexcept(false)
+{
+	int index = indexOf(node);
+	if(index == NO_NEXT_ITEM)
+		throw std::invalid_argument("LA::removeItem(..): Non-existent item");
+
+	neighs.erase(neighs.begin() + index);
+	probs.erase(probs.begin() + index);
+	lastTimes.erase(lastTimes.begin() + index);
+	sizes.erase(sizes.begin() + index);
+	estimates.erase(estimates.begin() + index);
+
+	double sum = 0;
+	for(double prob : probs)
+		sum += prob;
+	for(auto& prob : probs)
+		prob = (sum > 0) ? prob / sum : 1.0 / probs.size();
+}
+
+/**
+ * Changes the size of an item.
+ *
+ * @param node The item
+ * @param size Its new size
+ * @throws std::invalid_argument The item is unknown to this LA
+ */
+void LA::resizeItem(int node, int size) noexcept(false)
+{
+	int index = indexOf(node);
+	if(index == NO_NEXT_ITEM)
+		throw std::invalid_argument("LA::resizeItem(..): Non-existent item");
+
+	sizes[index] = size;
 }
 
 /**
- * Chooses the next item considering its cost value.
+ * Chooses the next item considering its cost value. The maximum is found in a single
+ * pass over the parallel arrays. Items with equal cost are sampled uniformly with a
+ * reservoir of size one, i.e., the k-th tie replaces the current choice with 
+ * probability 1/k, so no candidate list is collected.
  *
  * @param time The current time value
  * @return int The chosen item
  */
 int LA::nextItem(double time)
 {
-	double maxCost = std::numeric_limits<double>::min();
-	int chosenNeigh = NO_NEXT_ITEM;
-	for(const auto& pair : probs)
-	{
-		double nodeCost = std::pow(time - lastTimes[pair.first], 2) 
-				* pair.second / sizes[pair.first];
-		// Keeping track of the item with the maximum cost
-		if(nodeCost > maxCost)
-			maxCost = nodeCost;
-	}
-	
-	std::vector<int> chosenNeighs;
-	for(const auto& pair : probs)
-		if(maxCost == std::pow(time - lastTimes[pair.first], 2) * pair.second / sizes[pair.first])
-			chosenNeighs.push_back(pair.first);
-	
-	// Collect all items with cost equal to maximum
-	if(chosenNeighs.size())
-	{
-		// Choose one by using a uniform distribution
-		std::uniform_int_distribution<> distro(0, chosenNeighs.size() - 1);
-		chosenNeigh = chosenNeighs[distro(gen)];
-	}
-	
-	return chosenNeigh;
+	return nextItem(time, gen);
 }
 
 /**
- * Constructor for the LaSystem. 
+ * Chooses the next item without modifying this LA; ties are broken with the given
+ * generator, so concurrent walks can share the automaton. Any generator with
+ * 64-bit output fits, the ones used in this project are instantiated below.
  *
- * @param filename The JSON filename containing the physical topology
- * @param iterations The number of iterations, LAs will use to converge
+ * @param time The current time value
+ * @param gen The caller's random generator
+ * @return int The chosen item
  */
-LaSystem::LaSystem(const std::string& filename, int iterations) 
+template<class Generator> int LA::nextItem(double time, Generator& gen) const
 {
-	maxLength = 0;
-	try
+	double maxCost = std::numeric_limits<double>::min();
+	int chosen = NO_NEXT_ITEM;
+	std::uint64_t ties = 0;
+	auto consider = [&](double nodeCost, int index)
+			{
+				// Keeping track of the item with the maximum cost
+				if(nodeCost > maxCost)
+				{
+					maxCost = nodeCost;
+					chosen = index;
+					ties = 1;
+				}
+				else if(nodeCost == maxCost && gen() % ++ties == 0)
+					chosen = index;
+			};
+
+	const int items = static_cast<int>(neighs.size());
+	int i = 0;
+#if defined(__AVX2__)
+	const __m256d now = _mm256_set1_pd(time);
+	for(; i + 4 <= items; i += 4)
 	{
-		initTopo(filename);
-		for(auto& edge : edges)
-		{
-			insertEdge(edge);
-			if(edge.weight > maxLength)
-				maxLength = edge.weight;
-		}
-		
+		__m256d elapsed = _mm256_sub_pd(now, _mm256_loadu_pd(&lastTimes[i]));
+		__m256d size = _mm256_cvtepi32_pd(_mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(&sizes[i])));
+		__m256d cost = _mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(elapsed, elapsed), 
+				_mm256_loadu_pd(&probs[i])), size);
+		// Most blocks cannot reach the running maximum, skip them without branching per item
+		if(!_mm256_movemask_pd(_mm256_cmp_pd(cost, _mm256_set1_pd(maxCost), _CMP_GE_OQ)))
+			continue;
+
+		alignas(32) double costs[4];
+		_mm256_store_pd(costs, cost);
+		for(int j = 0; j < 4; ++j)
+			consider(costs[j], i + j);
 	}
-	catch(std::exception& e)
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	const float64x2_t now = vdupq_n_f64(time);
+	for(; i + 2 <= items; i += 2)
 	{
-		std::cerr << e.what() << std::endl;
+		float64x2_t elapsed = vsubq_f64(now, vld1q_f64(&lastTimes[i]));
+		float64x2_t size = vcvtq_f64_s64(vmovl_s32(vld1_s32(&sizes[i])));
+		float64x2_t cost = vdivq_f64(vmulq_f64(vmulq_f64(elapsed, elapsed), 
+				vld1q_f64(&probs[i])), size);
+		// Blocks that cannot reach the running maximum are skipped
+		if(!vmaxvq_u32(vreinterpretq_u32_u64(vcgeq_f64(cost, vdupq_n_f64(maxCost)))))
+			continue;
+
+		consider(vgetq_lane_f64(cost, 0), i);
+		consider(vgetq_lane_f64(cost, 1), i + 1);
+	}
+#endif
+	for(; i < items; ++i)
+	{
+		double elapsed = time - lastTimes[i];
+		consider(elapsed * elapsed * probs[i] / sizes[i], i);
 	}
 	
-	this->iterations = (iterations > 0) ? iterations : ITERATIONS;
+	return (chosen == NO_NEXT_ITEM) ? NO_NEXT_ITEM : neighs[chosen];
 }
 
+template int LA::nextItem(double, SplitMix64&) const;
+template int LA::nextItem(double, std::mt19937_64&) const;
+
 /**
- * Constructor for the LaSystem. 
+ * Draws the next item at random, without modifying this LA. Each item is drawn in
+ * proportion to the score nextItem(..) maximises, so walks that read the same
+ * automata spread over the items they would favour instead of agreeing.
  *
- * @param iterations The number of iterations, LAs will use to converge
+ * @param time The current time value
+ * @param gen The caller's random generator
+ * @return int The drawn item
  */
-LaSystem::LaSystem(int iterations) 
+template<class Generator> int LA::drawItem(double time, Generator& gen) const
 {
-	maxLength = 0;
-	this->iterations = (iterations > 0) ? iterations : ITERATIONS;
+	if(neighs.empty())
+		return NO_NEXT_ITEM;
+
+	auto score = [&](std::size_t i)
+			{
+				double elapsed = time - lastTimes[i];
+				return elapsed * elapsed * probs[i] / sizes[i];
+			};
+	double total = 0;
+	for(std::size_t i = 0; i < neighs.size(); ++i)
+		total += score(i);
+	// The top 53 bits give a uniform value in [0,1)
+	double target = static_cast<double>(gen() >> 11) * 0x1.0p-53 * total;
+	for(std::size_t i = 0; i + 1 < neighs.size(); ++i)
+		if((target -= score(i)) < 0)
+			return neighs[i];
+
+	return neighs.back();
 }
 
-/**
- * Empty destructor.
- */
-LaSystem::~LaSystem() { }
+template int LA::drawItem(double, SplitMix64&) const;
+template int LA::drawItem(double, std::mt19937_64&) const;
 
 /**
- * Inserts a new edge to the LA System. Reconstructs the virtual topology internally.
- *
- * @param src Edge's startpoint
- * @param dest Edge's endpoint
- * @param weight Edge's weight
+ * Convergence criteria constructor. All criteria are disabled, i.e., path(..)
+ * always runs the full number of iterations.
  */
-void LaSystem::insertEdge(int src, int dest, double weight)
+LaSystem::Convergence::Convergence()
 {
-	AdaptiveSystem::insertEdge(src, dest, weight);   
-	localEdges.clear();
-	las.clear();
-	maxLength = 0;
-	for(auto& edge : edges)
-	{
-		insertEdge(edge);
-		if(edge.weight > maxLength)
-			maxLength = edge.weight;
-	}
+	stableIterations = 0;
+	probability = 0;
 }
 
 /**
- * Inserts a new edge to the LA System. Constructs the virtual topology internally.
- *
- * @param edge The edge to be inserted
+ * Statistics constructor, all counters start from zero.
  */
-void LaSystem::insertEdge(Edge edge)
+LaSystem::Stats::Stats()
 {
-	localEdges.insert(edge);
-	
-	LA la;
-	la.insertItem(edge.edgeEnd, sizeFromLength(edge.weight));
-	// Every node is mapped to an LA. Each LA contains and evaluates its neighbours.
-	if(las.find(edge.edgeStart) == las.end())
-		las[edge.edgeStart] = la;
-	else
-		las[edge.edgeStart].insertItem(edge.edgeEnd, sizeFromLength(edge.weight));
-	
-	LA la2;
-	if(las.find(edge.edgeEnd) == las.end())
-		las[edge.edgeEnd] = la2;
+	walks = failedWalks = cycleAborts = walkSteps = 0;
+	lastImprovement = 0;
+	traversalTime = feedbackTime = std::chrono::nanoseconds::zero();
 }
 
 /**
- * Creates a size value from an edge's length. This value will be considered from the LA
- * for choosing the next item.
+ * Accumulates the counters of another query. The last improvement becomes the
+ * other query's one.
  *
- * @param length The weight of an edge
+ * @param rhs The counters to be added
+ * @return Stats& This instance
  */
-int LaSystem::sizeFromLength(double length)
+LaSystem::Stats& LaSystem::Stats::operator+=(const Stats& rhs)
 {
-	std::array<int, 8> availSizes{1, 2, 3, 4, 5, 6, 7, 8};
-	if(length >= maxLength) 
-		return availSizes[7];
-	if(length <= 0) 
-		return availSizes[0];
-	
-	return availSizes[static_cast<int>(std::floor(availSizes.size() 
-			* length / (maxLength + 1)))];
+	walks += rhs.walks;
+	failedWalks += rhs.failedWalks;
+	cycleAborts += rhs.cycleAborts;
+	walkSteps += rhs.walkSteps;
+	lastImprovement = rhs.lastImprovement;
+	traversalTime += rhs.traversalTime;
+	feedbackTime += rhs.feedbackTime;
+
+	return *this;
 }
 
 /**
- * Finds the best path from source node to destination using the LA system.
+ * Returns the average number of nodes per walk.
  *
- * @param src Starting node
- * @param dest Ending node
- * @return std::vector<int> The converged path
+ * @return double The average walk length, zero without walks
  */
-std::vector<int> LaSystem::path(int src, int dest)
+double LaSystem::Stats::averageWalk() const
 {
-	std::list<int> bestPath;
-	double evaluation = std::numeric_limits<double>::max();
-	double time = TIME_SLOT;
-	
-	// All these attempts will be made
-	for(int i = 1; i <= iterations; ++i)
-	{
-		std::list<int> path;
-		traverse(src, dest, path, time);
-		if(path.front() != src || path.back() != dest)
-		{
-			// Failed to find a path
-			// Path nodes will have their 'chosen' timestamps updated
-			applyTimeChange(path, time);
-			time += TIME_SLOT;
-			continue;
-		}
-			
-		double length = std::numeric_limits<double>::max();
-		try
-		{ 
-			// A valid path is found, so it will be evaluated
-			length = pathLength(path);
-		}
-		catch(std::exception& exc) 
-		{
-			// Evaluation failed, cancel this attempt
-			applyTimeChange(path, time);
-			time += TIME_SLOT;
-			continue;
-		}
-		
-		// Lower evaluation values are better, so keep the lowest
-		if(length < evaluation)
-		{
-			evaluation = length;
-			bestPath.clear();
-			bestPath = path;
-		}	
-		
-		// Update path's nodes with the calculated feedback
-		applyFeedback(path, time, calcFeedback(path));
-		time += TIME_SLOT;
-	}
-
-	std::vector<int> retPath;
-	for(int node : bestPath)
-		retPath.push_back(node);
-	
-	return retPath;
+	return walks ? static_cast<double>(walkSteps) / walks : 0;
 }
 
 /**
- * Path length calculation method.
- *
- * @param path The path to be evaluated
- * @return double The given path's length
- * @throws std::invalid_argument Invalid path value
+ * Workspace constructor.
  */
-double LaSystem::pathLength(const std::list<int>& path) const noexcept(false)
+LaSystem::Workspace::Workspace()
 {
-	if(path.size() <= 1 || static_cast<int>(path.size()) > las.size())
-		throw std::invalid_argument("LaSystem::pathLength(..): No suitable path");
-
-	std::vector<int> vecPath;
-	for(int node : path)
-		vecPath.push_back(node);
-	
-	double weightSum = 0;
-	// For every path segment
-	for(int i = 0; i < (int)vecPath.size() - 1; ++i)
-	{
-		// Find the edges that start with current node using the next lambda function
-		std::for_each(localEdges.cbegin(), localEdges.cend(),
-				[&vecPath, i, &weightSum](Edge edge)
-				{ 
-					if(edge.edgeStart == vecPath[i] && edge.edgeEnd == vecPath[i + 1])
-						weightSum += edge.weight;
-				});
-	}
-	
-	return weightSum;
+	epoch = 0;
+	table = nullptr;
+	candidates = nullptr;
+	iterations = improvedAt = budget = 0;
 }
 
 /**
- * Applies a feedback value to a path's nodes.
- *
- * @param path The path containing the nodes
- * @param time The current update time
- * @param feedback The feedback value in range [0-1]
+ * Result constructor, for a query without a path.
  */
-void LaSystem::applyFeedback(std::list<int>& path, double time, double feedback)
+LaSystem::Result::Result()
 {
-	std::vector<int> vecPath;
-	for(int node : path)
-		vecPath.push_back(node);
-		
-	// Get the right LA for path's nodes and update the probability for the neighbour
-	for(unsigned int i = 0; i < vecPath.size() - 1; ++i)
-		try
-		{
-			getLA(vecPath[i])->updateProbs(vecPath[i + 1], time, feedback);
-		}
-		catch(std::exception& exc)
-		{
-			std::cerr << exc.what() << std::endl;
-		}
+	weight = std::numeric_limits<double>::infinity();
+	converged = false;
 }
 
 /**
- * Applies a time change value to path's nodes.
+ * Table constructor, the table allocates from the given allocator's resource.
  *
- * @param path The path containing the nodes
- * @param time The current update time
+ * @param alloc The allocator
  */
-void LaSystem::applyTimeChange(std::list<int>& path, double time)
-{
-	std::vector<int> vecPath;
-	for(int node : path)
-		vecPath.push_back(node);
-		
-	for(unsigned int i = 0; i < vecPath.size() - 1; ++i)
-		try
-		{
-			getLA(vecPath[i])->timeChange(vecPath[i + 1], time);
-		}
-		catch(std::exception& exc)
-		{
-			std::cerr << exc.what() << std::endl;
-		}
-}
+LaSystem::Table::Table(const allocator_type& alloc) : slots(alloc), clones(alloc), owners(alloc) { }
 
 /**
- * Calculates the feedback for a given path.
+ * Copy constructor towards another allocator.
  *
- * @param path The path containing the nodes
- * @return double The feedback value [0,1]
+ * @param rhs The table to be copied
+ * @param alloc The allocator of the copy
  */
-double LaSystem::calcFeedback(std::list<int>& path)
-{
-	return 1 - path.size() / static_cast<double>(las.size());
-}
+LaSystem::Table::Table(const Table& rhs, const allocator_type& alloc) 
+		: slots(rhs.slots, alloc), clones(rhs.clones, alloc), owners(rhs.owners, alloc), 
+		recent(rhs.recent) { }
 
 /**
- * Recursive method to find a path between two nodes. All valid results are returned.
+ * Move constructor towards another allocator.
  *
- * @param node Current node
- * @param dest Destination to be reached
- * @param path Current path node sequence
- * @param currentTime Current time slot
+ * @param rhs The table to be moved
+ * @param alloc The allocator of the new table
  */
-void LaSystem::traverse(int node, int dest, std::list<int>& path, double currentTime)
+LaSystem::Table::Table(Table&& rhs, const allocator_type& alloc) 
+		: slots(std::move(rhs.slots), alloc), clones(std::move(rhs.clones), alloc), 
+		owners(std::move(rhs.owners), alloc), recent(rhs.recent) { }
+
+/**
+ * Target constructor, the destination takes no part until it gets a table.
+ */
+LaSystem::Target::Target()
 {
-	path.push_back(node);
-	if(node == dest || detectCycle(path))
-		return;
-	
-	int nextNode;
-	if((nextNode = getLA(node)->nextItem(currentTime)) == LA::NO_NEXT_ITEM)
-		return;
-	
-	// Recurse to the next node
-	traverse(nextNode, dest, path, currentTime);
+	table = nullptr;
+	evaluation = std::numeric_limits<double>::max();
+	credits = improvedAt = 0;
+	active = met = false;
 }
 
 /**
- * Returns the LA that is mapped to a node.
+ * Crew constructor, the walkers are submitted by the query.
  *
- * @param item The item that is mapped to an LA containing its neighbours
- * @return LA* The LA pointer
+ * @param walkers The walkers of a round, the calling thread included
+ * @param pool The pool that runs the other walkers
  */
-LA* LaSystem::getLA(int item)
+LaSystem::Crew::Crew(int walkers, ThreadPool& pool) : start(walkers), end(walkers), pool(pool)
 {
-	return &las[item];
+	time = 0;
+	stopping = false;
 }
 
 /**
- * Detects if a cycle is formed inside the sequence of nodes.
- *
- * @param items The sequence of nodes
- * @return bool Indication of a cyclic sequence
+ * Destructor that releases the waiting walkers and waits for them to return.
  */
-bool LaSystem::detectCycle(const std::list<int>& items)
+LaSystem::Crew::~Crew()
 {
-	std::set<int> uniqueItems;
-	for(int item : items)
-		uniqueItems.insert(item);
-	
-	return items.size() != uniqueItems.size();
+	stopping = true;
+	start.arrive_and_wait();
+	try
+	{
+		pool.wait();
+	}
+	catch(std::exception& exc)
+	{
+		std::cerr << exc.what() << std::endl;
+	}
 }
 
 /**
- * Clears instance's state
+ * Constructor for the LaSystem. 
+ *
+ * @param filename The JSON filename containing the physical topology
+ * @param iterations The number of iterations, LAs will use to converge
+ * @param resource Supplies the storage of the topology and its automata, see
+ *        LaSystem(int, std::pmr::memory_resource*)
  */
-void LaSystem::clear()
+LaSystem::LaSystem(const std::string& filename, int iterations, 
+		std::pmr::memory_resource* resource) 
+		: AdaptiveSystem(resource), denseIds(resource), externalIds(resource), adjacency(resource), 
+		las(resource), tables(resource), recentDests(resource)
 {
-	localEdges.clear();
-	edges.clear();
-	las.clear();
+	maxLength = 0;
+	adjacencyDirty = false;
+	perDestination = false;
+	maxTables = 0;
+	walkers = 1;
+	statistics = false;
+	autoIterations = false;
+	observedImprovement = 0;
+	deadline = std::chrono::nanoseconds::zero();
+	generation = 1;
+	seed = std::random_device()();
+	try
+	{
+		initTopo(filename);
+	}
+	catch(std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+	}
+	
+	this->iterations = (iterations > 0) ? iterations : ITERATIONS;
+}
+
+/**
+ * Constructor for the LaSystem. All storage that follows the topology comes from
+ * the given resource: edges, node ids, adjacency arrays, the automata and their
+ * per-destination tables. Scratch state of queries and the route cache use the
+ * default resource. With a monotonic arena, building costs a few bulk allocations
+ * and releasing memory costs nothing; clear() gives all storage back, so the arena
+ * may be released before the next topology is built. The resource must be
+ * thread-safe if paths(..) batches run in per-destination mode on several threads.
+ *
+ * @param iterations The number of iterations, LAs will use to converge
+ * @param resource Supplies the storage of the topology and its automata
+ */
+LaSystem::LaSystem(int iterations, std::pmr::memory_resource* resource) 
+		: AdaptiveSystem(resource), denseIds(resource), externalIds(resource), adjacency(resource), 
+		las(resource), tables(resource), recentDests(resource)
+{
+	maxLength = 0;
+	adjacencyDirty = false;
+	perDestination = false;
+	maxTables = 0;
+	walkers = 1;
+	statistics = false;
+	autoIterations = false;
+	observedImprovement = 0;
+	deadline = std::chrono::nanoseconds::zero();
+	generation = 1;
+	seed = std::random_device()();
+	this->iterations = (iterations > 0) ? iterations : ITERATIONS;
+}
+
+/**
+ * Empty destructor.
+ */
+LaSystem::~LaSystem() { }
+
+/**
+ * Returns the dense id of a node, numbering it first if it is new. A new node
+ * receives an LA with its own generator stream.
+ *
+ * @param node The external node id
+ * @return int The dense node id
+ */
+int LaSystem::intern(int node)
+{
+	auto [it, created] = denseIds.try_emplace(node, static_cast<int>(externalIds.size()));
+	if(created)
+	{
+		externalIds.push_back(node);
+		las.emplace_back().reseed(SplitMix64::stream(seed, node)());
+	}
+
+	return it->second;
+}
+
+/**
+ * Translates an external node id.
+ *
+ * @param node The external node id
+ * @return int The dense node id or NO_NODE, if the node is unknown
+ */
+int LaSystem::denseId(int node) const
+{
+	auto it = denseIds.find(node);
+	return (it != denseIds.end()) ? it->second : NO_NODE;
+}
+
+/**
+ * Translates a path of dense node ids to external ones, in place.
+ *
+ * @param path The path
+ */
+void LaSystem::toExternal(std::vector<int>& path) const
+{
+	for(auto& node : path)
+		node = externalIds[node];
+}
+
+/**
+ * Returns a copy of the edges with dense node ids, numbering new nodes.
+ *
+ * @return std::vector<Edge> The edges
+ */
+std::vector<AdaptiveSystem::Edge> LaSystem::denseEdges()
+{
+	std::vector<Edge> links(edges.begin(), edges.end());
+	for(auto& link : links)
+	{
+		link.edgeStart = intern(link.edgeStart);
+		link.edgeEnd = intern(link.edgeEnd);
+	}
+
+	return links;
+}
+
+/**
+ * Forgets the numbering of the nodes, together with all automata.
+ */
+void LaSystem::resetNodes()
+{
+	// Swapping with empty containers also gives their capacity back to the resource
+	std::pmr::unordered_map<int, int>(denseIds.get_allocator()).swap(denseIds);
+	std::pmr::vector<int>(externalIds.get_allocator()).swap(externalIds);
+	std::pmr::vector<LA>(las.get_allocator()).swap(las);
+	std::pmr::unordered_map<int, Table>(tables.get_allocator()).swap(tables);
+	recentDests.clear();
+	routes.clear();
+	++generation;
+}
+
+/**
+ * Inserts a new edge to the LA System. Only the LA of the edge's startpoint is
+ * updated, so learned probabilities survive the topology change.
+ *
+ * @param src Edge's startpoint
+ * @param dest Edge's endpoint
+ * @param weight Edge's weight
+ */
+void LaSystem::insertEdge(int src, int dest, double weight)
+{
+	materialise();
+	AdaptiveSystem::insertEdge(src, dest, weight);
+	adjacencyDirty = true;
+	int from = intern(src), to = intern(dest);
+	routes.invalidateNode(src);
+	forEachLA(from, [this, to, weight](LA& la) { la.insertItem(to, sizeFromLength(weight)); });
+	// The new item exists now, so it is resized together with the others
+	if(weight > maxLength)
+	{
+		maxLength = weight;
+		resizeItems();
+	}
+}
+
+/**
+ * Removes all edges between two nodes. Only the LA of the startpoint is updated.
+ *
+ * @param src Edge's startpoint
+ * @param dest Edge's endpoint
+ * @throws std::invalid_argument Non-existent edge
+ */
+void LaSystem::removeEdge(int src, int dest) noexcept(false)
+{
+	materialise();
+	AdaptiveSystem::removeEdge(src, dest);
+	adjacencyDirty = true;
+	routes.invalidateLink(src, dest);
+	int to = denseId(dest);
+	forEachLA(denseId(src), [to](LA& la) { la.removeItem(to); });
+	if(updateMaxLength())
+		resizeItems();
+}
+
+/**
+ * Changes the weight of all edges between two nodes. Only the item size inside
+ * the startpoint's LA changes, unless the maximum length is affected.
+ *
+ * @param src Edge's startpoint
+ * @param dest Edge's endpoint
+ * @param weight The new weight
+ * @throws std::invalid_argument Non-existent edge
+ */
+void LaSystem::updateWeight(int src, int dest, double weight) noexcept(false)
+{
+	materialise();
+	AdaptiveSystem::updateWeight(src, dest, weight);
+	adjacencyDirty = true;
+	routes.invalidateLink(src, dest);
+	int to = denseId(dest);
+	if(updateMaxLength())
+		resizeItems();
+	else
+		forEachLA(denseId(src), [this, to, weight](LA& la) { la.resizeItem(to, sizeFromLength(weight)); });
+}
+
+/**
+ * Inserts a batch of edges to the LA System. Into an empty system the virtual
+ * topology is constructed only one time, after all edges are appended. A system
+ * that already has automata keeps them: the batch is applied like insertEdge(..)
+ * calls, except that item sizes are derived again at most once.
+ *
+ * @param batch The edges to be inserted
+ */
+void LaSystem::insertEdges(std::span<const Edge> batch)
+{
+	materialise();
+	AdaptiveSystem::insertEdges(batch);
+	if(las.empty())
+	{
+		rebuild();
+		return;
+	}
+
+	adjacencyDirty = true;
+	double length = maxLength;
+	for(const auto& edge : batch)
+	{
+		int from = intern(edge.edgeStart), to = intern(edge.edgeEnd);
+		routes.invalidateNode(edge.edgeStart);
+		forEachLA(from, [this, to, &edge](LA& la) { la.insertItem(to, sizeFromLength(edge.weight)); });
+		length = std::max(length, edge.weight);
+	}
+	if(length > maxLength)
+	{
+		maxLength = length;
+		resizeItems();
+	}
+}
+
+/**
+ * Reconstructs the numbering, adjacency and LAs from all known edges. Nodes are
+ * numbered in the order they first appear.
+ */
+void LaSystem::rebuild() noexcept(false)
+{
+	resetNodes();
+	auto links = denseEdges();
+	adjacency.build(links, static_cast<int>(externalIds.size()));
+	adjacencyDirty = false;
+	buildAutomata();
+}
+
+/**
+ * Fills the LAs of the numbered nodes from the adjacency. The maximum length is
+ * found first, so every item size is derived from the final value.
+ */
+void LaSystem::buildAutomata()
+{
+	routes.clear();
+	observedImprovement = 0;
+	maxLength = 0;
+	for(int node = 0; node < adjacency.nodes(); ++node)
+		for(double weight : adjacency.weights(node))
+			if(weight > maxLength)
+				maxLength = weight;
+
+	// Every node is mapped to an LA. Each LA contains and evaluates its neighbours.
+	for(int node = 0; node < adjacency.nodes(); ++node)
+	{
+		auto neighs = adjacency.neighbours(node);
+		auto weights = adjacency.weights(node);
+		for(std::size_t i = 0; i < neighs.size(); ++i)
+			las[node].insertItem(neighs[i], sizeFromLength(weights[i]));
+	}
+}
+
+/**
+ * Recreates the edge list of a topology that was mapped from an image, so it
+ * can be changed. The adjacency is rebuilt from it on the next query.
+ */
+void LaSystem::materialise()
+{
+	if(!adjacency.mapped() || !edges.empty())
+		return;
+
+	std::vector<Edge> links;
+	links.reserve(adjacency.edges());
+	for(int node = 0; node < adjacency.nodes(); ++node)
+	{
+		auto neighs = adjacency.neighbours(node);
+		auto weights = adjacency.weights(node);
+		for(std::size_t i = 0; i < neighs.size(); ++i)
+		{
+			Edge edge;
+			edge.edgeStart = externalIds[node];
+			edge.edgeEnd = externalIds[neighs[i]];
+			edge.weight = weights[i];
+			links.push_back(edge);
+		}
+	}
+	AdaptiveSystem::insertEdges(links);
+}
+
+/**
+ * Initialises the topology either from a JSON file or by mapping a topology image.
+ * Images are used in place, so queries can start without any parsing; only the
+ * translation of their node ids is built.
+ *
+ * @param filename The JSON file or image containing the physical topology
+ * @throws std::runtime_error Unreadable or malformed file
+ */
+void LaSystem::initTopo(const std::string& filename)
+{
+	if(!Adjacency::isImage(filename))
+	{
+		AdaptiveSystem::initTopo(filename);
+		return;
+	}
+
+	adjacency.map(filename);
+	adjacencyDirty = false;
+	resetNodes();
+	auto labels = adjacency.labels();
+	for(std::size_t node = 0; node < labels.size(); ++node)
+		if(intern(labels[node]) != static_cast<int>(node))
+		{
+			adjacency.clear();
+			resetNodes();
+			throw std::runtime_error("LaSystem::initTopo(..): Duplicate node id in " + filename);
+		}
+	buildAutomata();
+}
+
+/**
+ * Writes the topology as an image that later instances can map, see initTopo(..).
+ *
+ * @param filename The image file
+ * @throws std::runtime_error The file cannot be written
+ */
+void LaSystem::saveTopology(const std::string& filename) noexcept(false)
+{
+	refresh();
+	adjacency.save(filename, externalIds);
+}
+
+/**
+ * Recalculates the maximum edge length.
+ *
+ * @return bool Indication of a changed value
+ */
+bool LaSystem::updateMaxLength()
+{
+	double length = 0;
+	for(const auto& edge : edges)
+		if(edge.weight > length)
+			length = edge.weight;
+
+	bool changed = length != maxLength;
+	maxLength = length;
+
+	return changed;
+}
+
+/**
+ * Derives again all item sizes from the edge lengths. Probabilities are untouched.
+ */
+void LaSystem::resizeItems()
+{
+	for(const auto& edge : edges)
+	{
+		int size = sizeFromLength(edge.weight);
+		int to = denseId(edge.edgeEnd);
+		forEachLA(denseId(edge.edgeStart), [to, size](LA& la) { la.resizeItem(to, size); });
+	}
+}
+
+/**
+ * Applies a change to the LA of a node, inside the shared automata and inside
+ * every per-destination table that has already cloned it.
+ *
+ * @param node The dense node id
+ * @param change The change to be applied
+ */
+void LaSystem::forEachLA(int node, const std::function<void(LA&)>& change)
+{
+	change(las[node]);
+	for(auto& [dest, table] : tables)
+		if(auto slot = table.slots.find(node); slot != table.slots.end())
+			change(table.clones[slot->second]);
+}
+
+/**
+ * Selects the automata that the current query will use. In per-destination mode
+ * the table of the destination is created if needed and the least recently used
+ * tables are evicted beyond the limit.
+ *
+ * @param dest The destination of the query
+ * @return Table* The table to be trained, nullptr for the shared automata
+ */
+LaSystem::Table* LaSystem::selectTable(int dest)
+{
+	if(!perDestination)
+		return nullptr;
+
+	Table* table = &tableFor(dest);
+	trimTables();
+
+	return table;
+}
+
+/**
+ * Returns the table of a destination, creating it if needed, and marks it as
+ * the most recently used one.
+ *
+ * @param dest The destination
+ * @return Table& Its table
+ */
+LaSystem::Table& LaSystem::tableFor(int dest)
+{
+	auto it = tables.find(dest);
+	if(it == tables.end())
+	{
+		recentDests.push_front(dest);
+		it = tables.emplace(dest, Table()).first;
+		it->second.recent = recentDests.begin();
+	}
+	else
+		recentDests.splice(recentDests.begin(), recentDests, it->second.recent);
+
+	return it->second;
+}
+
+/**
+ * Evicts the least recently used tables beyond the limit.
+ */
+void LaSystem::trimTables()
+{
+	while(maxTables > 0 && tables.size() > maxTables)
+	{
+		tables.erase(recentDests.back());
+		recentDests.pop_back();
+	}
+}
+
+/**
+ * Creates a size value from an edge's length. This value will be considered from the LA
+ * for choosing the next item.
+ *
+ * @param length The weight of an edge
+ */
+int LaSystem::sizeFromLength(double length)
+{
+	std::array<int, 8> availSizes{1, 2, 3, 4, 5, 6, 7, 8};
+	if(length >= maxLength) 
+		return availSizes[7];
+	if(length <= 0) 
+		return availSizes[0];
+	
+	return availSizes[static_cast<int>(std::floor(availSizes.size() 
+			* length / (maxLength + 1)))];
+}
+
+/**
+ * Finds the best path from source node to destination using the LA system.
+ *
+ * @param src Starting node
+ * @param dest Ending node
+ * @return std::vector<int> The converged path, empty for unknown nodes
+ */
+std::vector<int> LaSystem::path(int src, int dest)
+{
+	std::vector<int> bestPath;
+	path(src, dest, bestPath);
+
+	return bestPath;
+}
+
+/**
+ * Finds the best path like path(int, int) but into a caller's buffer. The best
+ * path is tracked by swapping buffers with the walks, so a buffer reused across
+ * queries soon has the capacity that makes them allocation-free.
+ *
+ * @param src Starting node
+ * @param dest Ending node
+ * @param bestPath Receives the path, emptied for unknown nodes
+ * @return Result The length of the path and an indication of convergence
+ */
+LaSystem::Result LaSystem::path(int src, int dest, std::vector<int>& bestPath)
+{
+	refresh();
+	Result result;
+	workspace.iterations = 0;
+	LAPATH_STAT(workspace.stats = Stats());
+	if(routes.find(src, dest, bestPath))
+	{
+		result.weight = 0;
+		for(std::size_t i = 0; i + 1 < bestPath.size(); ++i)
+			result.weight += adjacency.weight(denseId(bestPath[i]), denseId(bestPath[i + 1]));
+		result.converged = true;
+		return result;
+	}
+
+	bestPath.clear();
+	int from = denseId(src), to = denseId(dest);
+	if(from == NO_NODE || to == NO_NODE)
+		return result;
+
+	workspace.table = selectTable(to);
+	result.converged = std::visit([&](const auto& policy, const auto& scheme)
+			{ return solve(from, to, workspace, bestPath, policy, scheme, true); }, 
+			feedback, reinforcement);
+	observe(workspace.improvedAt, workspace.budget);
+	if(!bestPath.empty())
+		result.weight = pathLength(bestPath);
+	toExternal(bestPath);
+	if(result.converged && !bestPath.empty())
+		routes.insert(src, dest, bestPath);
+
+	return result;
+}
+
+/**
+ * Finds up to k distinct paths from source node to destination. They are the
+ * cheapest valid walks evaluated while the query converges, kept in a bounded
+ * heap, so no separate solver is needed for backup routes. The route cache is
+ * bypassed, but the best path is cached when it converges.
+ *
+ * @param src Starting node
+ * @param dest Ending node
+ * @param k The number of paths
+ * @param disjoint Keeps only paths that share no link, in either direction
+ * @return std::vector<std::vector<int>> The paths, cheapest first; empty for
+ *         unknown nodes
+ */
+std::vector<std::vector<int>> LaSystem::kPaths(int src, int dest, std::size_t k, bool disjoint)
+{
+	refresh();
+	workspace.iterations = 0;
+	LAPATH_STAT(workspace.stats = Stats());
+	int from = denseId(src), to = denseId(dest);
+	if(from == NO_NODE || to == NO_NODE || k == 0)
+		return {};
+
+	PathHeap heap(k, disjoint);
+	std::vector<int> bestPath;
+	workspace.table = selectTable(to);
+	workspace.candidates = &heap;
+	bool done = std::visit([&](const auto& policy, const auto& scheme)
+			{ return solve(from, to, workspace, bestPath, policy, scheme, true); }, 
+			feedback, reinforcement);
+	workspace.candidates = nullptr;
+	observe(workspace.improvedAt, workspace.budget);
+	toExternal(bestPath);
+	if(done && !bestPath.empty())
+		routes.insert(src, dest, bestPath);
+
+	auto result = heap.take();
+	for(auto& alternative : result)
+		toExternal(alternative);
+
+	return result;
+}
+
+/**
+ * Finds the best paths for a batch of queries in parallel. Queries towards the
+ * same destination form one task and run one after the other, so every LA is
+ * trained by a single thread at a time. In per-destination mode a task owns the
+ * destination's table. Otherwise the shared automata are only read, a task
+ * trains a snapshot of its worker that clones them lazily and is emptied before
+ * the next task, so the batch holds one snapshot per worker rather than per
+ * destination. No other member may be called while the batch runs.
+ *
+ * @param queries Pairs of starting and ending nodes
+ * @return std::vector<std::vector<int>> The converged paths, in query order
+ * @throws std::exception An error of any task
+ */
+std::vector<std::vector<int>> LaSystem::paths(std::span<const std::pair<int, int>> queries) noexcept(false)
+{
+	refresh();
+	std::vector<std::vector<int>> results(queries.size());
+	std::vector<std::pair<int, int>> dense(queries.size());
+	std::unordered_map<int, std::vector<std::size_t>> groups;
+	for(std::size_t q = 0; q < queries.size(); ++q)
+	{
+		if(routes.find(queries[q].first, queries[q].second, results[q]))
+			continue;
+		dense[q] = {denseId(queries[q].first), denseId(queries[q].second)};
+		if(dense[q].first != NO_NODE && dense[q].second != NO_NODE)
+			groups[dense[q].second].push_back(q);
+	}
+	if(groups.empty())
+		return results;
+
+	if(!pool)
+		pool = std::make_unique<ThreadPool>();
+	workspaces.resize(pool->size());
+	for(auto& ws : workspaces)
+		prepare(ws);
+
+	// The tables are created here, tasks only modify the automata inside them.
+	// Snapshots belong to the workers and are emptied for every destination, so
+	// they only ever hold the clones of the group being trained
+	std::vector<Table> snapshots(perDestination ? 0 : workspaces.size());
+	std::vector<char> done(queries.size(), 0);
+	std::vector<std::pair<int, int>> improved(queries.size(), {-1, 0});
+	for(const auto& [dest, group] : groups)
+	{
+		Table* table = perDestination ? &tableFor(dest) : nullptr;
+		pool->submit([this, table, &snapshots, &group, &dense, &results, &done, &improved](int worker)
+				{
+					Workspace& ws = workspaces[worker];
+					ws.table = table;
+					if(!table)
+					{
+						ws.table = &snapshots[worker];
+						ws.table->slots.clear();
+						ws.table->clones.clear();
+						ws.table->owners.clear();
+					}
+					for(std::size_t q : group)
+					{
+						done[q] = std::visit([&](const auto& policy, const auto& scheme)
+								{ return solve(dense[q].first, dense[q].second, ws, results[q], 
+										policy, scheme); }, feedback, reinforcement);
+						improved[q] = {ws.improvedAt, ws.budget};
+						// The buffer may be a walk buffer, sized for the longest walk
+						results[q].shrink_to_fit();
+						toExternal(results[q]);
+					}
+				});
+	}
+	pool->wait();
+	trimTables();
+
+	// Observed in query order, so the budget does not depend on the scheduling
+	for(auto [at, budget] : improved)
+		if(at >= 0)
+			observe(at, budget);
+
+	for(const auto& [dest, group] : groups)
+		for(std::size_t q : group)
+			if(done[q] && !results[q].empty())
+				routes.insert(queries[q].first, queries[q].second, results[q]);
+
+	return results;
+}
+
+/**
+ * Finds the best paths from a source towards every node it reaches. Each walk
+ * heads for one destination, in turns, and every prefix of it is a path towards
+ * the node where the prefix ends, so the walk is credited to all the running
+ * destinations it passes through. Every destination trains its own table and
+ * stops as soon as its own criteria are met or its budget of credited walks is
+ * spent. At most MAX_LIVE_TARGETS destinations run at once, the nearest first,
+ * and each finished one lets the next start. Tables are those of per-destination
+ * mode, otherwise private snapshots that are recycled as destinations finish, so
+ * memory follows the running destinations rather than the reachable ones. A
+ * deadline bounds the whole call.
+ *
+ * @param src Starting node
+ * @return RouteTable The best paths keyed by their destination, empty for an
+ *         unknown node; unreached destinations are missing
+ */
+LaSystem::RouteTable LaSystem::paths(int src)
+{
+	refresh();
+	RouteTable result;
+	workspace.iterations = 0;
+	LAPATH_STAT(workspace.stats = Stats());
+	int from = denseId(src);
+	if(from == NO_NODE)
+		return result;
+
+	// Only reachable destinations take part, the others would never be credited
+	Targets targets;
+	targets.progress.resize(las.size());
+	targets.admitted = 0;
+	std::vector<char> seen(las.size(), 0);
+	std::vector<int> frontier{from};
+	seen[from] = 1;
+	for(std::size_t next = 0; next < frontier.size(); ++next)
+		for(int node : adjacency.neighbours(frontier[next]))
+		{
+			if(seen[node])
+				continue;
+			seen[node] = 1;
+			frontier.push_back(node);
+			std::vector<int> cached;
+			if(routes.find(src, externalIds[node], cached))
+				result.emplace(externalIds[node], std::move(cached));
+			else
+				targets.order.push_back(node);
+		}
+
+	admit(targets);
+	std::visit([&](const auto& policy, const auto& scheme)
+			{ explore(from, targets, policy, scheme); }, feedback, reinforcement);
+	workspace.table = nullptr;
+	trimTables();
+
+	for(std::size_t k = 0; k < targets.order.size(); ++k)
+	{
+		int node = targets.order[k];
+		Target& target = targets.progress[node];
+		if(k < targets.admitted)
+			observe(target.improvedAt, workspace.budget);
+		if(target.best.empty())
+			continue;
+		toExternal(target.best);
+		if(target.met)
+			routes.insert(src, externalIds[node], target.best);
+		result.emplace(externalIds[node], std::move(target.best));
+	}
+
+	return result;
+}
+
+/**
+ * Starts waiting destinations of a single-source query until MAX_LIVE_TARGETS
+ * are running or none is left. Each gets its per-destination table, otherwise a
+ * snapshot, reusing one left by a finished destination when possible.
+ *
+ * @param targets The destinations of the query
+ */
+void LaSystem::admit(Targets& targets)
+{
+	while(targets.active.size() < MAX_LIVE_TARGETS && targets.admitted < targets.order.size())
+	{
+		int node = targets.order[targets.admitted++];
+		Target& target = targets.progress[node];
+		if(perDestination)
+			target.table = &tableFor(node);
+		else if(!targets.spare.empty())
+		{
+			target.table = targets.spare.back();
+			targets.spare.pop_back();
+		}
+		else
+			target.table = &targets.snapshots.emplace_back();
+		target.active = true;
+		targets.active.push_back(node);
+	}
+}
+
+/**
+ * Finds the best paths between all pairs of nodes, one single-source query
+ * after the other.
+ *
+ * @return std::unordered_map<int, RouteTable> The route table of every source
+ */
+std::unordered_map<int, LaSystem::RouteTable> LaSystem::allPaths()
+{
+	std::unordered_map<int, RouteTable> result;
+	for(std::size_t node = 0; node < externalIds.size(); ++node)
+		result.emplace(externalIds[node], paths(externalIds[node]));
+
+	return result;
+}
+
+/**
+ * Runs the iterations of a query on the workspace's automata. With several walkers
+ * and the parallel option, the iterations run in rounds of that many walks. The
+ * first walker follows the automata like a sequential walk, the others draw their
+ * choices from the probabilities so the walks of a round differ. All sample against
+ * the same probabilities, at consecutive time slots, on as many threads as there
+ * are cores; the helper threads stay on the pool for the whole query. The steps of
+ * all the walks are then combined and applied at once, rewards of the same choice
+ * adding up. Every walk of a round is an iteration of the budget. A deadline ends the iterations early;
+ * the best path found until then is kept but does not count as converged.
+ *
+ * @param src Starting node
+ * @param dest Ending node
+ * @param ws The workspace of the calling thread
+ * @param bestPath Receives the best path found
+ * @param policy The feedback policy
+ * @param scheme The reinforcement scheme
+ * @param parallel Allows the use of parallel walkers
+ * @return bool Indication of a converged result
+ */
+template<class Policy, class Scheme> bool LaSystem::solve(int src, int dest, Workspace& ws, 
+		std::vector<int>& bestPath, const Policy& policy, const Scheme& scheme, bool parallel)
+{
+	bestPath.clear();
+	LAPATH_STAT(ws.stats = Stats());
+	int budget = iterationBudget();
+	bool timed = deadline > std::chrono::nanoseconds::zero();
+	auto expiry = timed ? std::chrono::steady_clock::now() + deadline 
+			: std::chrono::steady_clock::time_point::max();
+	int sinceCheck = 0;
+	bool met = false;
+	double evaluation = std::numeric_limits<double>::max();
+	double time = TIME_SLOT;
+	int improvedAt = 0;
+	int round = parallel ? walkers : 1;
+	// Threads sampling the walks of a round, the calling one included
+	int threads = 1;
+	std::unique_ptr<Crew> crew;
+	if(round > 1)
+	{
+		walkerSpaces.resize(round);
+		for(int k = 0; k < round; ++k)
+		{
+			prepare(walkerSpaces[k]);
+			// Walker streams restart per query, so seeded runs are reproducible
+			walkerSpaces[k].gen = SplitMix64::stream(~seed, k);
+			LAPATH_STAT(walkerSpaces[k].stats = Stats());
+		}
+		if(!pool)
+			pool = std::make_unique<ThreadPool>();
+		// Threads beyond the cores would only take turns, those beyond the pool
+		// would never open the barriers
+		int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+		threads = std::min({round, cores, pool->size() + 1});
+	}
+	if(threads > 1)
+	{
+		crew = std::make_unique<Crew>(threads, *pool);
+		for(int t = 1; t < threads; ++t)
+			pool->submit([this, src, dest, &ws, &crew = *crew, round, threads, t](int)
+					{
+						for(crew.start.arrive_and_wait(); !crew.stopping; crew.start.arrive_and_wait())
+						{
+							for(int k = t; k < round; k += threads)
+								sample(src, dest, walkerSpaces[k], ws.table, crew.time + k * TIME_SLOT, true);
+							crew.end.arrive_and_wait();
+						}
+					});
+	}
+	
+	// All these attempts will be made, unless a convergence criterion is met earlier
+	int i = 1;
+	while(i <= budget)
+	{
+		if(converged(ws, bestPath, i - improvedAt))
+		{
+			met = true;
+			break;
+		}
+		// The clock is read every few iterations only
+		if(timed && (sinceCheck += round) >= DEADLINE_STRIDE)
+		{
+			sinceCheck = 0;
+			if(std::chrono::steady_clock::now() >= expiry)
+				break;
+		}
+
+		LAPATH_STAT(ws.lapStart = std::chrono::steady_clock::now());
+		if(round == 1)
+		{
+			// The walk buffer keeps its capacity, so no allocation takes place here
+			traverse(src, dest, ws, time);
+			LAPATH_STAT(lap(ws, &Stats::traversalTime));
+			if(learn(ws, ws.walk, src, dest, time, evaluation, bestPath, policy, scheme))
+				improvedAt = i;
+			LAPATH_STAT(lap(ws, &Stats::feedbackTime));
+			time += TIME_SLOT;
+			++i;
+			continue;
+		}
+
+		if(crew)
+		{
+			crew->time = time;
+			crew->start.arrive_and_wait();
+		}
+		for(int k = 0; k < round; k += threads)
+			sample(src, dest, walkerSpaces[k], ws.table, time + k * TIME_SLOT, k > 0);
+		if(crew)
+			crew->end.arrive_and_wait();
+		LAPATH_STAT(lap(ws, &Stats::traversalTime));
+
+		// The last round may only need some of the walks
+		int walks = std::min(round, budget - i + 1);
+		ws.steps.clear();
+		for(int k = 0; k < walks; ++k)
+		{
+			bool improved = false;
+			std::vector<int>& walk = walkerSpaces[k].walk;
+			double feedback = assess(ws, walk, src, dest, evaluation, bestPath, improved, policy);
+			if(improved)
+				improvedAt = i + k;
+			const std::vector<int>& steps = improved ? bestPath : walk;
+			for(std::size_t j = 0; j + 1 < steps.size(); ++j)
+				ws.steps.push_back({steps[j], steps[j + 1], time + k * TIME_SLOT, feedback});
+		}
+		applySteps(ws, scheme);
+		LAPATH_STAT(lap(ws, &Stats::feedbackTime));
+		time += round * TIME_SLOT;
+		i += walks;
+	}
+
+	ws.iterations = i - 1;
+	ws.improvedAt = improvedAt;
+	ws.budget = budget;
+	if(round > 1)
+		for(int k = 0; k < round; ++k)
+			LAPATH_STAT(ws.stats += walkerSpaces[k].stats);
+	LAPATH_STAT(ws.stats.lastImprovement = improvedAt; ws.totals += ws.stats);
+
+	// Without criteria, completing all iterations counts as convergence
+	return met || (i > budget && convergence.stableIterations <= 0 && convergence.probability <= 0);
+}
+
+/**
+ * Evaluates a walk and trains the automata with it.
+ *
+ * @param ws The workspace whose automata are trained
+ * @param path The walk, swapped with the best path on improvement
+ * @param src Starting node
+ * @param dest Ending node
+ * @param time The time slot of the walk
+ * @param evaluation The cost of the best path, updated on improvement
+ * @param bestPath The best path, updated on improvement
+ * @param policy The feedback policy, which evaluates and rewards the walk
+ * @param scheme The reinforcement scheme of the LAs
+ * @return bool Indication of an improved best path
+ */
+template<class Policy, class Scheme> bool LaSystem::learn(Workspace& ws, 
+		std::vector<int>& path, int src, int dest, double time, double& evaluation, 
+		std::vector<int>& bestPath, const Policy& policy, const Scheme& scheme)
+{
+	bool improved = false;
+	double feedback = assess(ws, path, src, dest, evaluation, bestPath, improved, policy);
+	if(feedback < 0)
+		// Path nodes will have their 'chosen' timestamps updated
+		applyTimeChange(ws, path, time);
+	else
+		// Update path's nodes with the policy's feedback
+		applyFeedback(ws, improved ? bestPath : path, time, feedback, scheme);
+
+	return improved;
+}
+
+/**
+ * Evaluates a walk, keeping it as the best path if it improves on it.
+ *
+ * @param ws The workspace of the query
+ * @param path The walk, swapped with the best path on improvement
+ * @param src Starting node
+ * @param dest Ending node
+ * @param evaluation The cost of the best path, updated on improvement
+ * @param bestPath The best path, updated on improvement
+ * @param improved Receives the indication of an improved best path
+ * @param policy The feedback policy, which evaluates and rewards the walk
+ * @return double The feedback of the walk, negative for a walk without a path
+ */
+template<class Policy> double LaSystem::assess(Workspace& ws, std::vector<int>& path, int src, 
+		int dest, double& evaluation, std::vector<int>& bestPath, bool& improved, const Policy& policy)
+{
+	if(path.front() != src || path.back() != dest)
+	{
+		// Failed to find a path
+		LAPATH_STAT(++ws.stats.failedWalks);
+		return -1;
+	}
+		
+	double length = std::numeric_limits<double>::max();
+	try
+	{ 
+		// A valid path is found, so it will be evaluated
+		length = pathLength(path);
+	}
+	catch(std::exception& exc) 
+	{
+		// Evaluation failed, cancel this attempt
+		LAPATH_STAT(++ws.stats.failedWalks);
+		return -1;
+	}
+	
+	// Lower evaluation values are better, so keep the lowest
+	int hops = static_cast<int>(path.size()) - 1;
+	double cost = policy.cost(length, hops);
+	if(ws.candidates)
+		ws.candidates->offer(path, cost);
+	improved = cost < evaluation;
+	if(improved)
+	{
+		// The walk buffer takes over the previous best path's buffer, nothing is copied
+		evaluation = cost;
+		bestPath.swap(path);
+	}	
+	
+	return policy.reward(cost, evaluation, hops, static_cast<int>(las.size()));
+}
+
+/**
+ * Applies the steps of a round of walks at once. Steps of the same choice are
+ * combined: their rewards add up and the latest time slot is kept, a choice
+ * only made by failed walks just has its timestamp updated.
+ *
+ * @param ws The workspace whose automata are updated and whose steps are applied
+ * @param scheme The reinforcement scheme
+ */
+template<class Scheme> void LaSystem::applySteps(Workspace& ws, const Scheme& scheme)
+{
+	std::sort(ws.steps.begin(), ws.steps.end(), [](const Step& a, const Step& b)
+			{ return a.node != b.node ? a.node < b.node : a.item < b.item; });
+	for(std::size_t first = 0, last = 0; first < ws.steps.size(); first = last)
+	{
+		Step combined = ws.steps[first];
+		for(last = first + 1; last < ws.steps.size() && ws.steps[last].node == combined.node 
+				&& ws.steps[last].item == combined.item; ++last)
+		{
+			const Step& step = ws.steps[last];
+			combined.time = std::max(combined.time, step.time);
+			if(step.feedback >= 0)
+				combined.feedback = std::max(combined.feedback, 0.0) + step.feedback;
+		}
+
+		try
+		{
+			LA* la = getLA(ws, combined.node);
+			if(combined.feedback < 0)
+				la->timeChange(combined.item, combined.time);
+			else
+				la->update(combined.item, combined.time, combined.feedback, scheme);
+		}
+		catch(std::exception& exc)
+		{
+			std::cerr << exc.what() << std::endl;
+		}
+	}
+}
+
+/**
+ * Path length calculation method.
+ *
+ * @param path The path to be evaluated
+ * @return double The given path's length
+ * @throws std::invalid_argument Invalid path value
+ */
+double LaSystem::pathLength(const std::vector<int>& path) const noexcept(false)
+{
+	if(path.size() <= 1 || path.size() > las.size())
+		throw std::invalid_argument("LaSystem::pathLength(..): No suitable path");
+
+	double weightSum = 0;
+	// For every path segment, look the link up among the start node's neighbours only
+	for(std::size_t i = 0; i + 1 < path.size(); ++i)
+		weightSum += adjacency.weight(path[i], path[i + 1]);
+	
+	return weightSum;
+}
+
+/**
+ * Applies a feedback value to a path's nodes.
+ *
+ * @param ws The workspace whose automata are updated
+ * @param path The path containing the nodes
+ * @param time The current update time
+ * @param feedback The feedback value in range [0-1]
+ * @param scheme The reinforcement scheme
+ */
+template<class Scheme> void LaSystem::applyFeedback(Workspace& ws, std::span<const int> path, 
+		double time, double feedback, const Scheme& scheme)
+{
+	// Get the right LA for path's nodes and update the probability for the neighbour
+	for(std::size_t i = 0; i + 1 < path.size(); ++i)
+		try
+		{
+			getLA(ws, path[i])->update(path[i + 1], time, feedback, scheme);
+		}
+		catch(std::exception& exc)
+		{
+			std::cerr << exc.what() << std::endl;
+		}
+}
+
+/**
+ * Applies a feedback value to a path's nodes, leaving the times their items were
+ * last selected unchanged.
+ *
+ * @param ws The workspace whose automata are updated
+ * @param path The path containing the nodes
+ * @param feedback The feedback value in range [0-1]
+ * @param scheme The reinforcement scheme
+ */
+template<class Scheme> void LaSystem::reinforce(Workspace& ws, std::span<const int> path, 
+		double feedback, const Scheme& scheme)
+{
+	for(std::size_t i = 0; i + 1 < path.size(); ++i)
+		try
+		{
+			getLA(ws, path[i])->reinforce(path[i + 1], feedback, scheme);
+		}
+		catch(std::exception& exc)
+		{
+			std::cerr << exc.what() << std::endl;
+		}
+}
+
+/**
+ * Applies a time change value to path's nodes.
+ *
+ * @param ws The workspace whose automata are updated
+ * @param path The path containing the nodes
+ * @param time The current update time
+ */
+void LaSystem::applyTimeChange(Workspace& ws, std::span<const int> path, double time)
+{
+	for(std::size_t i = 0; i + 1 < path.size(); ++i)
+		try
+		{
+			getLA(ws, path[i])->timeChange(path[i + 1], time);
+		}
+		catch(std::exception& exc)
+		{
+			std::cerr << exc.what() << std::endl;
+		}
+}
+
+/**
+ * Checks the configured convergence criteria against the best path found so far.
+ *
+ * @param ws The workspace whose automata are inspected
+ * @param best The best path
+ * @param stable Iterations since the best path last changed
+ * @return bool Indication of a met criterion
+ */
+bool LaSystem::converged(Workspace& ws, const std::vector<int>& best, int stable) noexcept(false)
+{
+	if(best.empty())
+		return false;
+	if(convergence.stableIterations > 0 && stable > convergence.stableIterations)
+		return true;
+	if(convergence.probability <= 0)
+		return false;
+
+	// Every LA along the path must point to its successor with high probability
+	for(std::size_t i = 0; i + 1 < best.size(); ++i)
+		if(getLA(ws, best[i])->probability(best[i + 1]) < convergence.probability)
+			return false;
+
+	return true;
+}
+
+/**
+ * Runs the walks of a single-source query until every destination is finished.
+ * Walks that miss their destination only update the 'chosen' timestamps of its
+ * table, their simple prefix still rewards the destinations along it.
+ *
+ * @param src Starting node
+ * @param targets The destinations of the query, some of them running
+ * @param policy The feedback policy
+ * @param scheme The reinforcement scheme
+ */
+template<class Policy, class Scheme> void LaSystem::explore(int src, Targets& targets, 
+		const Policy& policy, const Scheme& scheme)
+{
+	Workspace& ws = workspace;
+	int budget = iterationBudget();
+	bool timed = deadline > std::chrono::nanoseconds::zero();
+	auto expiry = timed ? std::chrono::steady_clock::now() + deadline 
+			: std::chrono::steady_clock::time_point::max();
+	int nodes = static_cast<int>(las.size());
+	double time = TIME_SLOT;
+	int walks = 0;
+	std::size_t turn = 0;
+	std::vector<int>& active = targets.active;
+	while(!active.empty())
+	{
+		if(timed && walks % DEADLINE_STRIDE == 0 && std::chrono::steady_clock::now() >= expiry)
+			break;
+
+		int dest = active[turn++ % active.size()];
+		ws.table = targets.progress[dest].table;
+		LAPATH_STAT(ws.lapStart = std::chrono::steady_clock::now());
+		traverse(src, dest, ws, time);
+		LAPATH_STAT(lap(ws, &Stats::traversalTime));
+		++walks;
+
+		std::span<const int> walk(ws.walk);
+		if(walk.back() != dest)
+		{
+			LAPATH_STAT(++ws.stats.failedWalks);
+			applyTimeChange(ws, walk, time);
+			++targets.progress[dest].credits;
+			// A walk closing a cycle ends with the repeated node
+			if(std::find(walk.begin(), walk.end() - 1, walk.back()) != walk.end() - 1)
+				walk = walk.first(walk.size() - 1);
+		}
+
+		double length = 0;
+		for(std::size_t k = 1; k < walk.size(); ++k)
+		{
+			length += adjacency.weight(walk[k - 1], walk[k]);
+			Target& target = targets.progress[walk[k]];
+			auto prefix = walk.first(k + 1);
+			int hops = static_cast<int>(k);
+			double cost = policy.cost(length, hops);
+			// Destinations that are not running keep the best path but learn nothing
+			if(target.active)
+				++target.credits;
+			if(cost < target.evaluation)
+			{
+				target.evaluation = cost;
+				target.best.assign(prefix.begin(), prefix.end());
+				target.improvedAt = target.credits;
+			}
+			if(!target.active)
+				continue;
+
+			ws.table = target.table;
+			applyFeedback(ws, prefix, time, policy.reward(cost, target.evaluation, hops, nodes), scheme);
+		}
+		LAPATH_STAT(lap(ws, &Stats::feedbackTime));
+		time += TIME_SLOT;
+
+		// Only the destinations credited by this walk may have finished
+		bool changed = finished(targets, dest, budget);
+		for(int node : walk)
+			changed = finished(targets, node, budget) || changed;
+		if(changed)
+		{
+			std::erase_if(active, [&targets](int node) { return !targets.progress[node].active; });
+			admit(targets);
+		}
+	}
+
+	ws.iterations = walks;
+	ws.improvedAt = 0;
+	ws.budget = budget;
+	LAPATH_STAT(ws.totals += ws.stats);
+}
+
+/**
+ * Ends a destination of a single-source query once its criteria are met or its
+ * budget is spent. The snapshot of a finished destination is cleared and kept
+ * for the next one to start.
+ *
+ * @param targets The destinations of the query
+ * @param node The destination
+ * @param budget The walks that may be credited to it
+ * @return bool Indication of a destination that has just finished
+ */
+bool LaSystem::finished(Targets& targets, int node, int budget) noexcept(false)
+{
+	Target& target = targets.progress[node];
+	if(!target.active)
+		return false;
+
+	workspace.table = target.table;
+	if(converged(workspace, target.best, target.credits - target.improvedAt))
+		target.met = true;
+	else if(target.credits >= budget)
+		// Without criteria, spending the whole budget counts as convergence
+		target.met = convergence.stableIterations <= 0 && convergence.probability <= 0;
+	else
+		return false;
+
+	target.active = false;
+	if(!perDestination)
+	{
+		*target.table = Table();
+		targets.spare.push_back(target.table);
+	}
+	target.table = nullptr;
+	return true;
+}
+
+/**
+ * Walks from a node towards the destination, following the choices of the LAs.
+ * The walk stops at the destination, at a repeated node or at a dead end.
+ *
+ * @param src Starting node
+ * @param dest Destination to be reached
+ * @param ws The workspace whose walk buffer receives the node sequence
+ * @param currentTime Current time slot
+ */
+void LaSystem::traverse(int src, int dest, Workspace& ws, double currentTime)
+{
+	ws.walk.clear();
+	beginWalk(ws);
+	for(int node = src; node != LA::NO_NEXT_ITEM; node = getLA(ws, node)->nextItem(currentTime))
+	{
+		ws.walk.push_back(node);
+		if(node == dest)
+			break;
+		if(detectCycle(ws, node))
+		{
+			LAPATH_STAT(++ws.stats.cycleAborts);
+			break;
+		}
+	}
+	LAPATH_STAT(++ws.stats.walks; ws.stats.walkSteps += ws.walk.size());
+}
+
+/**
+ * Walks like traverse(..) but only reads the automata, so several walks can run
+ * concurrently. LAs not cloned yet are read from the shared automata.
+ *
+ * @param src Starting node
+ * @param dest Destination to be reached
+ * @param ws The workspace of the walker
+ * @param table The table to be read, nullptr for the shared automata
+ * @param currentTime Current time slot
+ * @param draw Draws every choice from the probabilities instead of following them
+ */
+void LaSystem::sample(int src, int dest, Workspace& ws, const Table* table, 
+		double currentTime, bool draw) const
+{
+	ws.walk.clear();
+	beginWalk(ws);
+	for(int node = src; node != LA::NO_NEXT_ITEM; )
+	{
+		ws.walk.push_back(node);
+		if(node == dest)
+			break;
+		if(detectCycle(ws, node))
+		{
+			LAPATH_STAT(++ws.stats.cycleAborts);
+			break;
+		}
+
+		const LA& la = readLA(table, node);
+		node = draw ? la.drawItem(currentTime, ws.gen) : la.nextItem(currentTime, ws.gen);
+	}
+	LAPATH_STAT(++ws.stats.walks; ws.stats.walkSteps += ws.walk.size());
+}
+
+/**
+ * Returns the LA that is mapped to a node.
+ *
+ * @param ws The workspace whose automata are used
+ * @param item The item that is mapped to an LA containing its neighbours
+ * @return LA* The LA pointer
+ */
+LA* LaSystem::getLA(Workspace& ws, int item)
+{
+	if(!ws.table)
+		return &las[item];
+
+	auto [slot, created] = ws.table->slots.try_emplace(item, static_cast<int>(ws.table->clones.size()));
+	if(created)
+	{
+		// First visit of this node for this table, start from the shared state
+		ws.table->clones.push_back(las[item]);
+		ws.table->owners.push_back(item);
+	}
+
+	return &ws.table->clones[slot->second];
+}
+
+/**
+ * Returns the LA of a node for reading, without cloning it.
+ *
+ * @param table The table, nullptr for the shared automata
+ * @param item The item that is mapped to an LA containing its neighbours
+ * @return const LA& The table's clone, or the shared LA if there is none
+ */
+const LA& LaSystem::readLA(const Table* table, int item) const
+{
+	if(table)
+		if(auto slot = table->slots.find(item); slot != table->slots.end())
+			return table->clones[slot->second];
+
+	return las[item];
+}
+
+/**
+ * Starts a new walk. Marks of previous walks become stale by advancing the epoch,
+ * so the visited array is wiped only when the counter wraps around.
+ *
+ * @param ws The workspace of the walk
+ */
+void LaSystem::beginWalk(Workspace& ws)
+{
+	if(++ws.epoch == 0)
+	{
+		std::fill(ws.visited.begin(), ws.visited.end(), 0);
+		ws.epoch = 1;
+	}
+}
+
+/**
+ * Marks a node as visited during the current walk and detects if a cycle is formed.
+ *
+ * @param ws The workspace of the walk
+ * @param node The node just appended to the walk
+ * @return bool Indication of a cyclic sequence
+ */
+bool LaSystem::detectCycle(Workspace& ws, int node)
+{
+	if(ws.visited[node] == ws.epoch)
+		return true;
+
+	ws.visited[node] = ws.epoch;
+	return false;
+}
+
+/**
+ * Brings the structures derived from the edges up to date after topology changes.
+ */
+void LaSystem::refresh()
+{
+	if(adjacencyDirty)
+	{
+		auto links = denseEdges();
+		adjacency.build(links, static_cast<int>(externalIds.size()));
+		adjacencyDirty = false;
+	}
+
+	prepare(workspace);
+}
+
+/**
+ * Sizes a workspace for the current topology.
+ *
+ * @param ws The workspace
+ */
+void LaSystem::prepare(Workspace& ws)
+{
+	if(ws.visited.size() != las.size())
+	{
+		ws.visited.assign(las.size(), 0);
+		ws.epoch = 0;
+		// A walk visits every node at most once, plus the one closing a cycle
+		ws.walk.reserve(las.size() + 1);
+	}
+}
+
+/**
+ * Sets the criteria which end path(..) before all iterations are made.
+ *
+ * @param criteria Stable iterations of the best path and/or a probability
+ *        threshold for every LA along it; zero values disable a criterion
+ */
+void LaSystem::setConvergence(const Convergence& criteria)
+{
+	convergence = criteria;
+}
+
+/**
+ * Selects the feedback policy, see feedback.h. The policy decides the cost by
+ * which best paths are chosen, so cached routes are dropped.
+ *
+ * @param policy The policy, e.g., WeightFeedback{} to converge to low-weight paths
+ */
+void LaSystem::setFeedback(const Feedback& policy)
+{
+	feedback = policy;
+	routes.clear();
+}
+
+/**
+ * Selects the reinforcement scheme of all LAs, see reinforcement.h, together with
+ * its rates. The learned probabilities are kept.
+ *
+ * @param scheme The scheme, e.g., Pursuit{} or RewardInaction{0.3} for faster L_RI
+ */
+void LaSystem::setReinforcement(const Reinforcement& scheme)
+{
+	reinforcement = scheme;
+}
+
+/**
+ * Enables automata per (node, destination) pair, so queries towards different
+ * destinations do not interfere and repeated ones start from warm state.
+ * Changing the mode drops all per-destination state.
+ *
+ * @param enabled Indication of per-destination automata
+ * @param limit The maximum number of destination tables kept, zero for no limit
+ */
+void LaSystem::setPerDestination(bool enabled, std::size_t limit)
+{
+	if(enabled != perDestination)
+	{
+		tables.clear();
+		recentDests.clear();
+	}
+
+	perDestination = enabled;
+	maxTables = limit;
+}
+
+/**
+ * Enables the cache of converged routes in front of path(..). Routes are dropped
+ * when an edge along them changes or when the topology is cleared.
+ *
+ * @param capacity The maximum number of cached routes, zero disables caching
+ */
+void LaSystem::setRouteCache(std::size_t capacity)
+{
+	routes.setCapacity(capacity);
+}
+
+/**
+ * Sets the number of workers used by paths(..).
+ *
+ * @param threads The number of workers, zero for the hardware concurrency
+ */
+void LaSystem::setThreads(int threads)
+{
+	pool = std::make_unique<ThreadPool>(threads);
+}
+
+/**
+ * Sets the number of walkers sampling concurrently during a single path(..) query.
+ * Every walk of a round counts as an iteration of the budget, so walkers spend it
+ * in fewer rounds. Batches of paths(..) are already parallel, so their queries use
+ * one walker.
+ *
+ * @param count The number of walkers, one for sequential iterations
+ */
+void LaSystem::setWalkers(int count)
+{
+	walkers = std::max(1, count);
+}
+
+/**
+ * Seeds the tie-breaking of all LAs and walkers. Every node draws from its own
+ * stream of the seed, so seeded runs are reproducible.
+ *
+ * @param value The seed
+ */
+void LaSystem::setSeed(std::uint64_t value)
+{
+	seed = value;
+	for(std::size_t node = 0; node < las.size(); ++node)
+		las[node].reseed(SplitMix64::stream(seed, externalIds[node])());
+	for(auto& [dest, table] : tables)
+	{
+		auto stream = seed ^ (static_cast<std::uint64_t>(externalIds[dest]) << 32);
+		for(std::size_t clone = 0; clone < table.clones.size(); ++clone)
+			table.clones[clone].reseed(SplitMix64::stream(stream, externalIds[table.owners[clone]])());
+	}
+}
+
+/**
+ * Returns the number of iterations the last path(..) query made before one of the
+ * convergence criteria was met, useful for tuning the iteration budget.
+ *
+ * @return int The iterations, zero for a cached route
+ */
+int LaSystem::lastIterations() const
+{
+	return workspace.iterations;
+}
+
+/**
+ * Enables the automatic iteration budget. The first queries get a budget that
+ * grows with the number of links. Afterwards it follows a moving average of the
+ * iteration at which queries last improved their best path, with a safety margin,
+ * so small topologies stop wasting iterations and large ones receive more. The
+ * observations restart when the topology is rebuilt.
+ *
+ * @param enabled Indication of the automatic budget, otherwise the constructor's
+ *        number of iterations is used
+ */
+void LaSystem::setAutoIterations(bool enabled)
+{
+	autoIterations = enabled;
+}
+
+/**
+ * Returns the number of iterations the next query may make.
+ *
+ * @return int The iteration budget
+ */
+int LaSystem::iterationBudget() const
+{
+	if(!autoIterations)
+		return iterations;
+
+	// Later improvements are found with larger budgets, so the estimate from the
+	// topology's size bounds how far the observations may raise it
+	double estimate = std::clamp(static_cast<double>(ITERATIONS_PER_LINK) * adjacency.edges(), 
+			static_cast<double>(MIN_ITERATIONS), static_cast<double>(MAX_ITERATIONS));
+	double budget = (observedImprovement > 0) ? BUDGET_MARGIN * observedImprovement : estimate;
+
+	return static_cast<int>(std::clamp(std::ceil(budget), static_cast<double>(MIN_ITERATIONS), 
+			BUDGET_MARGIN * estimate));
+}
+
+/**
+ * Bounds the latency of every query, e.g., "the best path within 2 ms". The
+ * iterations stop at the deadline, measured with a monotonic clock, and the best
+ * path found until then is returned. Such paths are not cached.
+ *
+ * @param limit The time limit of a query, zero for none
+ */
+void LaSystem::setDeadline(std::chrono::nanoseconds limit)
+{
+	deadline = limit;
+}
+
+/**
+ * Feeds the automatic budget with the iteration that last improved a query's path.
+ * A query without any path needed more than its whole budget, which counts twice.
+ *
+ * @param improvedAt The iteration, zero if no path was found
+ * @param budget The budget of the query
+ */
+void LaSystem::observe(int improvedAt, int budget)
+{
+	double needed = (improvedAt > 0) ? improvedAt : 2.0 * budget / BUDGET_MARGIN;
+	observedImprovement = (observedImprovement > 0) 
+			? (1 - OBSERVATION_WEIGHT) * observedImprovement + OBSERVATION_WEIGHT * needed 
+			: needed;
+}
+
+/**
+ * Enables the collection of statistics. Counters are kept per thread, so enabled
+ * statistics only add a few increments and two clock reads per iteration. Builds
+ * without LAPATH_STATS compile them out, all counters stay zero then.
+ *
+ * @param enabled Indication of collected statistics
+ */
+void LaSystem::setStats(bool enabled)
+{
+	statistics = enabled;
+}
+
+/**
+ * Returns the statistics of the last path(..) query.
+ *
+ * @return const Stats& The counters, all zero for a cached route
+ */
+const LaSystem::Stats& LaSystem::lastStats() const
+{
+	return workspace.stats;
+}
+
+/**
+ * Returns the statistics of all path(..) and paths(..) queries since the last
+ * resetStats(..). No query may run concurrently.
+ *
+ * @return Stats The accumulated counters
+ */
+LaSystem::Stats LaSystem::totalStats() const
+{
+	Stats total = workspace.totals;
+	for(const auto& ws : workspaces)
+		total += ws.totals;
+
+	return total;
+}
+
+/**
+ * Clears all statistics.
+ */
+void LaSystem::resetStats()
+{
+	workspace.stats = workspace.totals = Stats();
+	for(auto& ws : workspaces)
+		ws.totals = Stats();
+}
+
+/**
+ * Adds the time since the last lap to a counter and starts a new lap.
+ *
+ * @param ws The workspace whose counters are updated
+ * @param counter The counter
+ */
+void LaSystem::lap(Workspace& ws, std::chrono::nanoseconds Stats::* counter)
+{
+	auto now = std::chrono::steady_clock::now();
+	ws.stats.*counter += std::chrono::duration_cast<std::chrono::nanoseconds>(now - ws.lapStart);
+	ws.lapStart = now;
+}
+
+/**
+ * Reports a measurement of a path that was actually used, e.g., a delay probe
+ * or a loss ratio mapped to a reward. It is queued without locks and applied
+ * later by drainFeedback(..). Safe to call from any number of threads.
+ *
+ * @param path The measured path, with external node ids
+ * @param value The reward of the path in range [0-1], clamped to it
+ * @return bool Indication of a queued measurement, false if the queue is full
+ *         or the value is not a number
+ */
+bool LaSystem::reportFeedback(std::span<const int> path, double value)
+{
+	if(std::isnan(value))
+		return false;
+
+	return measurements.push(path, std::clamp(value, 0.0, 1.0));
+}
+
+/**
+ * Applies reported measurements, in report order, with the reinforcement scheme.
+ * Each one rewards the shared automata along its path, and the table of the
+ * path's destination if it has one. Only probabilities change; the times items
+ * were last selected belong to the walks and stay as they are. No iterations are
+ * made, so the automata follow the live conditions continuously. The cached route
+ * of the measured pair is invalidated. It must be called from the thread that
+ * trains the system; paths with unknown nodes or links are discarded.
+ *
+ * @param max The most measurements to be applied, zero for all queued ones
+ * @return std::size_t The number of measurements drained, discarded ones included
+ */
+std::size_t LaSystem::drainFeedback(std::size_t max)
+{
+	refresh();
+	std::vector<int>& dense = workspace.walk;
+	return measurements.drain([this, &dense](std::span<const int> path, double value)
+			{
+				dense.clear();
+				for(int node : path)
+					dense.push_back(denseId(node));
+				if(std::ranges::find(dense, NO_NODE) != dense.end())
+					return;
+				try
+				{
+					pathLength(dense);
+				}
+				catch(std::exception& exc)
+				{
+					return;
+				}
+
+				auto table = perDestination ? tables.find(dense.back()) : tables.end();
+				std::visit([&](const auto& scheme)
+						{
+							workspace.table = nullptr;
+							reinforce(workspace, dense, value, scheme);
+							if(table != tables.end())
+							{
+								workspace.table = &table->second;
+								reinforce(workspace, dense, value, scheme);
+							}
+						}, reinforcement);
+				workspace.table = nullptr;
+				routes.invalidateRoute(path.front(), path.back());
+			}, max);
+}
+
+/**
+ * Publishes the current best next hops, of the shared automata and of every
+ * per-destination table, for readers on other threads; see nextHops(). It must
+ * be called from the thread that trains the system, e.g., between queries. The
+ * previous publication stays readable meanwhile, so readers never wait. A table
+ * contributes only the hops of its clones that differ from the shared ones, so
+ * the work and memory follow the clones rather than the number of nodes.
+ */
+void LaSystem::publish()
+{
+	NextHopTable::Snapshot& copy = forwarding.beginPublish();
+	if(copy.generation != generation)
+	{
+		copy.index.clear();
+		copy.towards.clear();
+		copy.generation = generation;
+	}
+	// Nodes are only appended between renumberings
+	for(std::size_t node = copy.index.size(); node < externalIds.size(); ++node)
+		copy.index.emplace(externalIds[node], static_cast<int>(node));
+
+	auto hopOf = [this](const LA& la)
+			{
+				int hop = la.bestItem();
+				return (hop == LA::NO_NEXT_ITEM) ? NextHopTable::NO_HOP : externalIds[hop];
+			};
+	copy.hops.resize(las.size());
+	for(std::size_t node = 0; node < las.size(); ++node)
+		copy.hops[node] = hopOf(las[node]);
+
+	// Tables evicted since this copy was last filled are dropped
+	std::erase_if(copy.towards, [this](const auto& entry) 
+			{ return !tables.contains(denseId(entry.first)); });
+	for(const auto& [dest, table] : tables)
+	{
+		auto& hops = copy.towards[externalIds[dest]];
+		hops.clear();
+		for(std::size_t clone = 0; clone < table.clones.size(); ++clone)
+		{
+			int node = table.owners[clone], hop = hopOf(table.clones[clone]);
+			if(hop != copy.hops[node])
+				hops.emplace(node, hop);
+		}
+	}
+	forwarding.endPublish();
+}
+
+/**
+ * Returns the forwarding table refreshed by publish(). Its lookups are lock-free
+ * and may run on any number of threads while this system keeps training.
+ *
+ * @return const NextHopTable& The table, with external node ids
+ */
+const NextHopTable& LaSystem::nextHops() const
+{
+	return forwarding;
+}
+
+/**
+ * Writes a checkpoint of all learned probabilities and estimates: a header followed
+ * by one record per LA. Records are written one at a time, nothing is buffered.
+ *
+ * @param out The output stream
+ * @throws std::runtime_error The stream failed
+ */
+void LaSystem::saveState(std::ostream& out) noexcept(false)
+{
+	std::uint32_t version = STATE_VERSION;
+	out.write(STATE_MAGIC, sizeof(STATE_MAGIC));
+	out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	for(std::size_t node = 0; node < las.size(); ++node)
+		writeRecord(out, SHARED_TABLE, node, las[node]);
+	for(const auto& [dest, table] : tables)
+		for(std::size_t clone = 0; clone < table.clones.size(); ++clone)
+			writeRecord(out, dest, table.owners[clone], table.clones[clone]);
+
+	if(!out)
+		throw std::runtime_error("LaSystem::saveState(..): Cannot write state");
+}
+
+/**
+ * Appends the records of some nodes to a checkpoint written by saveState(..) of the
+ * current version, e.g., of the nodes trained since. When loading, later records
+ * override earlier ones.
+ *
+ * @param out The output stream, positioned at the end of a checkpoint
+ * @param nodes The nodes whose LAs are written, shared and per destination
+ * @throws std::runtime_error The stream failed
+ */
+void LaSystem::appendState(std::ostream& out, std::span<const int> nodes) noexcept(false)
+{
+	for(int external : nodes)
+	{
+		int node = denseId(external);
+		if(node == NO_NODE)
+			continue;
+		writeRecord(out, SHARED_TABLE, node, las[node]);
+		for(const auto& [dest, table] : tables)
+			if(auto slot = table.slots.find(node); slot != table.slots.end())
+				writeRecord(out, dest, node, table.clones[slot->second]);
+	}
+
+	if(!out)
+		throw std::runtime_error("LaSystem::appendState(..): Cannot write state");
+}
+
+/**
+ * Restores a checkpoint of the current or an earlier version. Records of nodes
+ * unknown to the current topology are skipped; records of a destination recreate
+ * its table in per-destination mode.
+ * Cached routes are dropped, since they may not match the restored state.
+ *
+ * @param in The input stream
+ * @throws std::runtime_error Not a checkpoint or truncated input
+ */
+void LaSystem::loadState(std::istream& in) noexcept(false)
+{
+	char magic[sizeof(STATE_MAGIC)] = {};
+	std::uint32_t version = 0;
+	in.read(magic, sizeof(magic));
+	in.read(reinterpret_cast<char*>(&version), sizeof(version));
+	if(!in || std::memcmp(magic, STATE_MAGIC, sizeof(magic)) != 0 
+			|| version < 1 || version > STATE_VERSION)
+		throw std::runtime_error("LaSystem::loadState(..): Not a state checkpoint");
+
+	routes.clear();
+	Workspace ws;
+	for(;;)
+	{
+		std::int32_t record[2];
+		if(!in.read(reinterpret_cast<char*>(record), sizeof(record)))
+			break;
+
+		int dest = (record[0] == SHARED_TABLE) ? SHARED_TABLE : denseId(record[0]);
+		int node = denseId(record[1]);
+		LA skipped;
+		LA* la = &skipped;
+		if(node != NO_NODE)
+		{
+			if(dest == SHARED_TABLE)
+				la = &las[node];
+			else if(perDestination && dest != NO_NODE)
+			{
+				ws.table = &tableFor(dest);
+				la = getLA(ws, node);
+			}
+		}
+		la->read(in, denseIds, version);
+	}
+	trimTables();
 }
 
+/**
+ * Writes the record of an LA. Checkpoints hold external ids, so they survive a
+ * different numbering of the nodes.
+ *
+ * @param out The output stream
+ * @param table The destination of the LA's table or SHARED_TABLE
+ * @param node The node of the LA
+ * @param la The LA
+ */
+void LaSystem::writeRecord(std::ostream& out, int table, int node, const LA& la) const
+{
+	std::int32_t record[2] = {(table == SHARED_TABLE) ? SHARED_TABLE : externalIds[table], 
+			externalIds[node]};
+	out.write(reinterpret_cast<const char*>(record), sizeof(record));
+	la.write(out, externalIds);
+}
+
+/**
+ * Clears instance's state
+ */
+void LaSystem::clear()
+{
+	adjacency.clear();
+	adjacencyDirty = false;
+	workspace = Workspace();
+	workspaces.clear();
+	walkerSpaces.clear();
+	std::pmr::vector<Edge>(edges.get_allocator()).swap(edges);
+	resetNodes();
+	observedImprovement = 0;
+	maxLength = 0;
+}
+
+/**
+ * Slot of a node without a clone, defined since containers bind it by reference
+ */
+const int LaSystem::NO_NODE;
+const std::size_t LaSystem::MAX_LIVE_TARGETS;
+
+/**
+ * Table id of the shared automata inside state checkpoints
+ */
+const int LaSystem::SHARED_TABLE = std::numeric_limits<std::int32_t>::min();
+
+/**
+ * Identifies state checkpoints, the last byte is the layout's endianness
+ */
+const char LaSystem::STATE_MAGIC[8] = {'L', 'A', 'S', 'T', 'A', 'T', 'E', 
+		static_cast<char>(std::endian::native == std::endian::little ? 'l' : 'b')};
+
+/**
+ * Layout of state checkpoints, version 2 adds the reward estimates of the LAs
+ */
+const std::uint32_t LaSystem::STATE_VERSION = 2;
+
+/**
+ * Factor between the observed iterations to improvement and the budget
+ */
+const double LaSystem::BUDGET_MARGIN = 8;
+
+/**
+ * Weight of the latest query inside the moving average of the automatic budget
+ */
+const double LaSystem::OBSERVATION_WEIGHT = 0.2;
+
 /**
  * Virtual slotted time for LA
  */
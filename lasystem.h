@@ -25,73 +25,359 @@
 #define LASYSTEM_H
 
 #include "adaptivesystem.h"
+#include "adjacency.h"
+#include "routecache.h"
+#include "pathheap.h"
+#include "nexthoptable.h"
+#include "feedbackqueue.h"
+#include "threadpool.h"
+#include "splitmix.h"
+#include "feedback.h"
+#include "reinforcement.h"
 #include <initializer_list>
 #include <random>
+#include <cstdint>
 #include <exception>
 #include <algorithm>
 #include <cmath>
 #include <limits>
 #include <iostream>
+#include <istream>
+#include <ostream>
 #include <array>
-#include <unordered_set>
+#include <chrono>
+#include <barrier>
 #include <unordered_map>
-#include <set>
+#include <deque>
 #include <list>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <variant>
+#include <span>
+#include <vector>
 
 class LA
 {
 public:
 	static const int DEFAULT_ITEM_SIZE = 1;
 	static const int NO_NEXT_ITEM = -1;
+	using allocator_type = std::pmr::polymorphic_allocator<>;
 	LA();
+	explicit LA(const allocator_type&);
 	LA(std::initializer_list<int>);						
+	LA(const LA&) = default;
+	LA(LA&&) noexcept = default;
+	LA(const LA&, const allocator_type&);
+	LA(LA&&, const allocator_type&);
+	LA& operator=(const LA&) = default;
+	LA& operator=(LA&&) = default;
 	~LA();
 	void insertItem(int, int = DEFAULT_ITEM_SIZE);		
+	void removeItem(int) noexcept(false);
+	void resizeItem(int, int) noexcept(false);
 	int nextItem(double);
+	template<class Generator> int nextItem(double, Generator&) const;
+	template<class Generator> int drawItem(double, Generator&) const;
+	void reseed(std::uint64_t);
+	void write(std::ostream&, std::span<const int>) const;
+	void read(std::istream&, const std::pmr::unordered_map<int, int>&, std::uint32_t) noexcept(false);
 	void updateProbs(int, double, double) noexcept(false);
+	template<class Scheme> void update(int, double, double, const Scheme&) noexcept(false);
+	template<class Scheme> void reinforce(int, double, const Scheme&) noexcept(false);
 	void timeChange(int, double) noexcept(false);
+	double probability(int) const noexcept(false);
+	int bestItem() const;
 	std::list<int> items();
 
 private:
-	std::map<int, double> probs;		
-	std::map<int, double> lastTimes;	
-	std::map<int, int> sizes;
-	std::mt19937_64 gen;
+	int indexOf(int) const;
+	// Parallel arrays, sorted by the item (neighbour) id
+	std::pmr::vector<int> neighs;
+	std::pmr::vector<double> probs;
+	std::pmr::vector<double> lastTimes;
+	std::pmr::vector<int> sizes;
+	// Reward estimates of estimator schemes
+	std::pmr::vector<double> estimates;
+	SplitMix64 gen;
 };
 
 class LaSystem : public AdaptiveSystem
 {
 public:
-	struct edgeHash
+	struct Convergence
 	{
-		size_t operator()(const AdaptiveSystem::Edge& edge) const
-		{
-			return std::hash<long int>()(edge.id);
-		}
+		Convergence();
+		int stableIterations;
+		double probability;
 	};
+
+	// Counters of path(..) queries, collected only when enabled through setStats(..)
+	struct Stats
+	{
+		Stats();
+		Stats& operator+=(const Stats&);
+		double averageWalk() const;
+		// Walks sampled
+		long int walks;
+		// Walks that did not yield a valid path
+		long int failedWalks;
+		// Walks stopped at a repeated node
+		long int cycleAborts;
+		// Nodes visited over all walks
+		long int walkSteps;
+		// The iteration that last improved the best path
+		int lastImprovement;
+		std::chrono::nanoseconds traversalTime;
+		std::chrono::nanoseconds feedbackTime;
+	};
+
+	using Feedback = std::variant<HopFeedback, WeightFeedback, LatencyFeedback, EnergyFeedback>;
+	using Reinforcement = std::variant<RewardInaction, RewardPenalty, Pursuit, Estimator>;
+	// Outcome of a path(..) query that fills a caller's buffer
+	struct Result
+	{
+		Result();
+		// Length of the path, infinity without a path
+		double weight;
+		bool converged;
+	};
+
+	// Paths from one source, keyed by their destination
+	using RouteTable = std::unordered_map<int, std::vector<int>>;
 	static const int ITERATIONS = 3000;
 	static const double TIME_SLOT;
-	LaSystem(const std::string&, int = 0);
-	LaSystem(int = 0);
+	LaSystem(const std::string&, int = 0, 
+			std::pmr::memory_resource* = std::pmr::get_default_resource());
+	LaSystem(int = 0, std::pmr::memory_resource* = std::pmr::get_default_resource());
+	LaSystem(const LaSystem&) = delete;
+	LaSystem& operator=(const LaSystem&) = delete;
 	virtual ~LaSystem();
 	virtual std::vector<int> path(int, int);
+	Result path(int, int, std::vector<int>&);
+	std::vector<std::vector<int>> paths(std::span<const std::pair<int, int>>) noexcept(false);
+	RouteTable paths(int);
+	std::vector<std::vector<int>> kPaths(int, int, std::size_t, bool = false);
+	std::unordered_map<int, RouteTable> allPaths();
 	virtual void insertEdge(int, int, double) noexcept(false);
+	virtual void insertEdges(std::span<const Edge>) noexcept(false);
+	virtual void removeEdge(int, int) noexcept(false);
+	virtual void updateWeight(int, int, double) noexcept(false);
 	virtual void clear();
+	void setConvergence(const Convergence&);
+	void setFeedback(const Feedback&);
+	void setReinforcement(const Reinforcement&);
+	void setPerDestination(bool, std::size_t = 0);
+	void setRouteCache(std::size_t);
+	void setThreads(int);
+	void setWalkers(int);
+	void setSeed(std::uint64_t);
+	int lastIterations() const;
+	void setAutoIterations(bool);
+	int iterationBudget() const;
+	void setDeadline(std::chrono::nanoseconds);
+	void setStats(bool);
+	const Stats& lastStats() const;
+	Stats totalStats() const;
+	void resetStats();
+	bool reportFeedback(std::span<const int>, double);
+	std::size_t drainFeedback(std::size_t = 0);
+	void publish();
+	const NextHopTable& nextHops() const;
+	void saveTopology(const std::string&) noexcept(false);
+	void saveState(std::ostream&) noexcept(false);
+	void appendState(std::ostream&, std::span<const int>) noexcept(false);
+	void loadState(std::istream&) noexcept(false);
 	
+protected:
+	virtual void initTopo(const std::string&);
+
 private:
-	void insertEdge(AdaptiveSystem::Edge);
-	void traverse(int, int, std::list<int>&, double);
-	bool detectCycle(const std::list<int>&);
-	LA* getLA(int);
-	double pathLength(const std::list<int>&) const noexcept(false);
-	void applyFeedback(std::list<int>&, double, double = 0.5);
-	void applyTimeChange(std::list<int>&, double);
-	double calcFeedback(std::list<int>&);
+	// Per-destination automata, their LAs are cloned lazily from the shared ones
+	struct Table
+	{
+		using allocator_type = std::pmr::polymorphic_allocator<>;
+		Table(const allocator_type& = {});
+		Table(const Table&, const allocator_type&);
+		Table(Table&&, const allocator_type&);
+		// Position of the clone of every cloned node, nodes never visited are missing
+		std::pmr::unordered_map<int, int> slots;
+		// Stable addresses, so growing the table keeps earlier clones in place
+		std::pmr::deque<LA> clones;
+		// Node of every clone, in the order of clones
+		std::pmr::vector<int> owners;
+		std::pmr::list<int>::iterator recent;
+	};
+	static const int NO_NODE = -1;
+	static const int MIN_ITERATIONS = 200;
+	static const int MAX_ITERATIONS = 1000000;
+	static const int ITERATIONS_PER_LINK = 10;
+	static const int DEADLINE_STRIDE = 8;
+	static const std::size_t MAX_LIVE_TARGETS = 256;
+	static const double BUDGET_MARGIN;
+	static const double OBSERVATION_WEIGHT;
+	static const int SHARED_TABLE;
+	static const char STATE_MAGIC[8];
+	static const std::uint32_t STATE_VERSION;
+	// Scratch state of a query, one instance per thread
+	// A step of a walk in a round of walkers, feedback is negative for a failed walk
+	struct Step
+	{
+		int node;
+		int item;
+		double time;
+		double feedback;
+	};
+	// Walkers after the first of a single path(..) query. They stay on the pool
+	// for the whole query and each round is started and ended by a barrier
+	struct Crew
+	{
+		Crew(int, ThreadPool&);
+		Crew(const Crew&) = delete;
+		Crew& operator=(const Crew&) = delete;
+		~Crew();
+		std::barrier<> start;
+		std::barrier<> end;
+		ThreadPool& pool;
+		// Time slot of the round's first walk, set before the round starts
+		double time;
+		bool stopping;
+	};
+	struct Workspace
+	{
+		Workspace();
+		// Epoch stamps of the nodes visited by the current walk
+		std::vector<unsigned int> visited;
+		unsigned int epoch;
+		// Reusable buffer for the node sequence of a walk
+		std::vector<int> walk;
+		// The table trained by the query, nullptr for the shared automata
+		Table* table;
+		// Receives every valid walk of the query, if set
+		PathHeap* candidates;
+		// Steps of the walks of a round, applied together
+		std::vector<Step> steps;
+		// Tie-breaking for walks that only read the automata
+		SplitMix64 gen;
+		// Iterations made by the last query, the one that last improved its path
+		// and its budget
+		int iterations;
+		int improvedAt;
+		int budget;
+		// Counters of the last query and of all queries since the last reset
+		Stats stats;
+		Stats totals;
+		std::chrono::steady_clock::time_point lapStart;
+	};
+	// Progress of one destination during a single-source query
+	struct Target
+	{
+		Target();
+		// The table trained towards this destination, nullptr while it is not running
+		Table* table;
+		std::vector<int> best;
+		double evaluation;
+		// Walks credited to this destination, the one that last improved its path
+		int credits;
+		int improvedAt;
+		bool active;
+		bool met;
+	};
+	// Destinations of a single-source query, only a bounded number run at once
+	struct Targets
+	{
+		// Progress of every destination, indexed by node
+		std::vector<Target> progress;
+		// Destinations running, in the order of their turns
+		std::vector<int> active;
+		// Destinations taking part in the order they start, the first 'admitted' have
+		std::vector<int> order;
+		std::size_t admitted;
+		// Snapshots of the shared mode, those of finished destinations are reused
+		std::deque<Table> snapshots;
+		std::vector<Table*> spare;
+	};
+
+	int intern(int);
+	int denseId(int) const;
+	void toExternal(std::vector<int>&) const;
+	std::vector<Edge> denseEdges();
+	void resetNodes();
+	void writeRecord(std::ostream&, int, int, const LA&) const;
+	void rebuild() noexcept(false);
+	void buildAutomata();
+	void materialise();
+	bool updateMaxLength();
+	void resizeItems();
+	void forEachLA(int, const std::function<void(LA&)>&);
+	Table* selectTable(int);
+	Table& tableFor(int);
+	void trimTables();
+	template<class Policy, class Scheme> bool solve(int, int, Workspace&, std::vector<int>&, 
+			const Policy&, const Scheme&, bool = false);
+	template<class Policy, class Scheme> bool learn(Workspace&, std::vector<int>&, int, 
+			int, double, double&, std::vector<int>&, const Policy&, const Scheme&);
+	template<class Policy> double assess(Workspace&, std::vector<int>&, int, int, double&, 
+			std::vector<int>&, bool&, const Policy&);
+	template<class Scheme> void applySteps(Workspace&, const Scheme&);
+	template<class Policy, class Scheme> void explore(int, Targets&, const Policy&, const Scheme&);
+	void admit(Targets&);
+	bool finished(Targets&, int, int) noexcept(false);
+	void traverse(int, int, Workspace&, double);
+	void sample(int, int, Workspace&, const Table*, double, bool) const;
+	static void beginWalk(Workspace&);
+	static bool detectCycle(Workspace&, int);
+	static void lap(Workspace&, std::chrono::nanoseconds Stats::*);
+	void refresh();
+	void prepare(Workspace&);
+	LA* getLA(Workspace&, int);
+	const LA& readLA(const Table*, int) const;
+	double pathLength(const std::vector<int>&) const noexcept(false);
+	template<class Scheme> void applyFeedback(Workspace&, std::span<const int>, double, double, 
+			const Scheme&);
+	template<class Scheme> void reinforce(Workspace&, std::span<const int>, double, const Scheme&);
+	void applyTimeChange(Workspace&, std::span<const int>, double);
+	bool converged(Workspace&, const std::vector<int>&, int) noexcept(false);
 	int sizeFromLength(double);
+	void observe(int, int);
 	double maxLength;
-	std::unordered_set<AdaptiveSystem::Edge, edgeHash> localEdges;  
-	std::unordered_map<int, LA> las;
+	// Nodes are numbered densely inside; external ids are translated only by the API
+	std::pmr::unordered_map<int, int> denseIds;
+	std::pmr::vector<int> externalIds;
+	Adjacency adjacency;
+	bool adjacencyDirty;
+	Workspace workspace;
+	// The shared automata, indexed by node
+	std::pmr::vector<LA> las;
+	bool perDestination;
+	std::size_t maxTables;
+	std::pmr::unordered_map<int, Table> tables;
+	std::pmr::list<int> recentDests;
+	// Converged results, invalidated by topology changes along them
+	RouteCache routes;
+	// Workers of paths(..) and their scratch state
+	std::unique_ptr<ThreadPool> pool;
+	std::vector<Workspace> workspaces;
+	// Parallel walkers of a single path(..) query
+	int walkers;
+	std::vector<Workspace> walkerSpaces;
+	// Every LA and walker draws from its own stream of this seed
+	std::uint64_t seed;
 	int iterations;
+	// Automatic budget, following the iterations that queries need to improve their paths
+	bool autoIterations;
+	double observedImprovement;
+	std::chrono::nanoseconds deadline;
+	Convergence convergence;
+	Feedback feedback;
+	Reinforcement reinforcement;
+	bool statistics;
+	// Best next hops for concurrent readers, refreshed by publish()
+	NextHopTable forwarding;
+	// Measurements reported from any thread, applied by drainFeedback(..)
+	FeedbackQueue measurements;
+	// Advanced whenever the nodes are renumbered
+	std::uint64_t generation;
 };
 
 #endif // LASYSTEM_H
@@ -0,0 +1,154 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#include "nexthoptable.h"
+
+/**
+ * Snapshot constructor, an empty table.
+ */
+NextHopTable::Snapshot::Snapshot()
+{
+	epoch = 0;
+	generation = 0;
+}
+
+/**
+ * Constructor, both copies are empty.
+ */
+NextHopTable::NextHopTable()
+{
+	active.store(0);
+	readers[0].store(0);
+	readers[1].store(0);
+}
+
+/**
+ * Empty destructor.
+ */
+NextHopTable::~NextHopTable() { }
+
+/**
+ * Looks the best next hop of a node up. Safe to call from any thread.
+ *
+ * @param node The node
+ * @return int The next hop, NO_HOP for unknown nodes and nodes without links
+ */
+int NextHopTable::nextHop(int node) const
+{
+	return read([node](const Snapshot& copy)
+			{
+				auto it = copy.index.find(node);
+				return (it == copy.index.end()) ? NO_HOP : copy.hops[it->second];
+			});
+}
+
+/**
+ * Looks the best next hop of a node towards a destination up. Destinations
+ * without automata of their own follow the shared ones. Safe to call from any
+ * thread.
+ *
+ * @param node The node
+ * @param dest The destination
+ * @return int The next hop, NO_HOP for unknown nodes, nodes without links and
+ *         the destination itself
+ */
+int NextHopTable::nextHop(int node, int dest) const
+{
+	return read([node, dest](const Snapshot& copy)
+			{
+				auto it = copy.index.find(node);
+				if(it == copy.index.end() || node == dest)
+					return NO_HOP;
+				auto table = copy.towards.find(dest);
+				if(table == copy.towards.end())
+					return copy.hops[it->second];
+				auto hop = table->second.find(it->second);
+				return (hop == table->second.end()) ? copy.hops[it->second] : hop->second;
+			});
+}
+
+/**
+ * Returns the number of the last publication.
+ *
+ * @return std::uint64_t The epoch, zero before the first publication
+ */
+std::uint64_t NextHopTable::epoch() const
+{
+	return read([](const Snapshot& copy) { return copy.epoch; });
+}
+
+/**
+ * Returns the copy that readers do not use, to be filled by the writer. Waits
+ * for the readers that entered it before the last publication, they only make
+ * a few lookups each. Must be followed by endPublish(), from the same thread.
+ *
+ * @return Snapshot& The copy to be filled, holding an older publication
+ */
+NextHopTable::Snapshot& NextHopTable::beginPublish()
+{
+	std::size_t next = 1 - active.load();
+	while(readers[next].load() != 0)
+		std::this_thread::yield();
+
+	return copies[next];
+}
+
+/**
+ * Makes the copy filled since beginPublish() the current one.
+ */
+void NextHopTable::endPublish()
+{
+	std::size_t current = active.load();
+	copies[1 - current].epoch = copies[current].epoch + 1;
+	active.store(1 - current);
+}
+
+/**
+ * Registers a reader on the current copy. A reader that loses the race against
+ * a publication retries on the new current copy.
+ *
+ * @return std::size_t The copy entered
+ */
+std::size_t NextHopTable::enter() const
+{
+	for(;;)
+	{
+		std::size_t copy = active.load();
+		readers[copy].fetch_add(1);
+		// Sequentially consistent, so the writer either sees this reader or it sees the flip
+		if(active.load() == copy)
+			return copy;
+		readers[copy].fetch_sub(1);
+	}
+}
+
+/**
+ * Unregisters a reader.
+ *
+ * @param copy The copy it entered
+ */
+void NextHopTable::leave(std::size_t copy) const
+{
+	readers[copy].fetch_sub(1);
+}
@@ -0,0 +1,101 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#ifndef NEXTHOPTABLE_H
+#define NEXTHOPTABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Forwarding table that one writer publishes while many readers look it up,
+ * none of them taking a lock. It is double buffered in the left-right manner:
+ * readers announce themselves on the counter of the copy they read, and the
+ * writer fills the other copy only after its last reader has left.
+ */
+class NextHopTable
+{
+public:
+	static const int NO_HOP = -1;
+	// One published copy of the table, with external node ids
+	struct Snapshot
+	{
+		Snapshot();
+		// Number of the publication that filled it, zero before the first one
+		std::uint64_t epoch;
+		// Position of every node in the arrays
+		std::unordered_map<int, int> index;
+		// Generation of the node numbering that the index follows
+		std::uint64_t generation;
+		// Best next hop of every node over the shared automata
+		std::vector<int> hops;
+		// Best next hops towards the destinations with their own automata, by
+		// position, of the nodes whose hop differs from the shared one
+		std::unordered_map<int, std::unordered_map<int, int>> towards;
+	};
+
+	NextHopTable();
+	NextHopTable(const NextHopTable&) = delete;
+	NextHopTable& operator=(const NextHopTable&) = delete;
+	~NextHopTable();
+	int nextHop(int) const;
+	int nextHop(int, int) const;
+	std::uint64_t epoch() const;
+	template<class Reader> auto read(Reader&&) const;
+	Snapshot& beginPublish();
+	void endPublish();
+
+private:
+	std::size_t enter() const;
+	void leave(std::size_t) const;
+	Snapshot copies[2];
+	// The copy that new readers enter
+	std::atomic<std::size_t> active;
+	mutable std::atomic<long int> readers[2];
+};
+
+/**
+ * Runs a reader on the current copy, which stays unchanged until it returns.
+ * Several lookups made within one reader are therefore consistent.
+ *
+ * @param reader Callable receiving a const Snapshot&
+ * @return auto The reader's result
+ */
+template<class Reader> auto NextHopTable::read(Reader&& reader) const
+{
+	struct Guard
+	{
+		const NextHopTable& table;
+		std::size_t copy;
+		~Guard() { table.leave(copy); }
+	} guard{*this, enter()};
+
+	return std::forward<Reader>(reader)(copies[guard.copy]);
+}
+
+#endif // NEXTHOPTABLE_H
@@ -0,0 +1,147 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#include "pathheap.h"
+#include <algorithm>
+
+/**
+ * Constructor for the heap of the best paths.
+ *
+ * @param capacity The number of paths to be kept
+ * @param linkDisjoint Keeps only paths that share no link, in either direction
+ */
+PathHeap::PathHeap(std::size_t capacity, bool linkDisjoint)
+{
+	limit = capacity;
+	disjoint = linkDisjoint;
+	heap.reserve(capacity + 1);
+}
+
+/**
+ * Empty destructor.
+ */
+PathHeap::~PathHeap() { }
+
+/**
+ * Offers a valid path. Paths already kept are ignored. In link-disjoint mode a
+ * path replaces the kept ones it shares links with only if it is cheaper than
+ * all of them, so the kept paths always remain disjoint.
+ *
+ * @param path The node sequence
+ * @param cost Its cost, lower is better
+ * @return bool Indication of a kept path
+ */
+bool PathHeap::offer(std::span<const int> path, double cost)
+{
+	if(limit == 0 || (heap.size() == limit && cost >= heap.front().cost))
+		return false;
+
+	for(const auto& kept : heap)
+		if(kept.cost == cost && std::ranges::equal(kept.nodes, path))
+			return false;
+
+	if(disjoint)
+	{
+		bool conflict = false;
+		for(const auto& kept : heap)
+			if(shareLink(kept.nodes, path))
+			{
+				if(kept.cost <= cost)
+					return false;
+				conflict = true;
+			}
+		if(conflict)
+		{
+			std::erase_if(heap, [path](const Candidate& kept) { return shareLink(kept.nodes, path); });
+			std::make_heap(heap.begin(), heap.end(), cheaper);
+		}
+	}
+
+	heap.push_back(Candidate{cost, std::vector<int>(path.begin(), path.end())});
+	std::push_heap(heap.begin(), heap.end(), cheaper);
+	if(heap.size() > limit)
+	{
+		std::pop_heap(heap.begin(), heap.end(), cheaper);
+		heap.pop_back();
+	}
+
+	return true;
+}
+
+/**
+ * Returns the number of kept paths.
+ *
+ * @return std::size_t The number of paths
+ */
+std::size_t PathHeap::size() const
+{
+	return heap.size();
+}
+
+/**
+ * Hands the kept paths over, leaving the heap empty.
+ *
+ * @return std::vector<std::vector<int>> The paths, cheapest first
+ */
+std::vector<std::vector<int>> PathHeap::take()
+{
+	std::sort_heap(heap.begin(), heap.end(), cheaper);
+	std::vector<std::vector<int>> paths;
+	paths.reserve(heap.size());
+	for(auto& kept : heap)
+		paths.push_back(std::move(kept.nodes));
+	heap.clear();
+
+	return paths;
+}
+
+/**
+ * Orders the candidates of the max-heap.
+ *
+ * @param lhs The first candidate
+ * @param rhs The second candidate
+ * @return bool Indication of a cheaper first candidate
+ */
+bool PathHeap::cheaper(const Candidate& lhs, const Candidate& rhs)
+{
+	return lhs.cost < rhs.cost;
+}
+
+/**
+ * Checks whether two paths traverse a common link, in either direction.
+ *
+ * @param lhs The first path
+ * @param rhs The second path
+ * @return bool Indication of a shared link
+ */
+bool PathHeap::shareLink(std::span<const int> lhs, std::span<const int> rhs)
+{
+	for(std::size_t i = 0; i + 1 < lhs.size(); ++i)
+		for(std::size_t j = 0; j + 1 < rhs.size(); ++j)
+			if((lhs[i] == rhs[j] && lhs[i + 1] == rhs[j + 1]) 
+					|| (lhs[i] == rhs[j + 1] && lhs[i + 1] == rhs[j]))
+				return true;
+
+	return false;
+}
@@ -0,0 +1,56 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#ifndef PATHHEAP_H
+#define PATHHEAP_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class PathHeap
+{
+public:
+	PathHeap(std::size_t, bool = false);
+	~PathHeap();
+	bool offer(std::span<const int>, double);
+	std::size_t size() const;
+	std::vector<std::vector<int>> take();
+
+private:
+	struct Candidate
+	{
+		double cost;
+		std::vector<int> nodes;
+	};
+
+	static bool cheaper(const Candidate&, const Candidate&);
+	static bool shareLink(std::span<const int>, std::span<const int>);
+	std::size_t limit;
+	bool disjoint;
+	// Max-heap on the cost, so the worst kept path is evicted first
+	std::vector<Candidate> heap;
+};
+
+#endif // PATHHEAP_H
@@ -0,0 +1,152 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#ifndef REINFORCEMENT_H
+#define REINFORCEMENT_H
+
+#include <span>
+
+/**
+ * Reinforcement schemes of LA. A scheme updates the action probabilities after
+ * the chosen action received a feedback value in range [0,1]. LA specialises its
+ * update for every scheme, so the loop over the actions is inlined. A scheme
+ * needs one const member:
+ *
+ *   void update(std::span<double> probs, std::span<double> estimates, 
+ *           std::size_t chosen, double feedback) const;
+ *
+ * where estimates holds a running reward estimate per action, zero initially,
+ * which estimator schemes maintain and the others ignore.
+ */
+
+/**
+ * Linear Reward-Inaction (L_RI). The chosen action gains in proportion to the
+ * feedback, nothing changes without feedback.
+ */
+struct RewardInaction
+{
+	// Determines the convergence speed to the actual demand
+	double rate = 0.15;
+	// Keeps low priority actions from reaching zero probability
+	double floor = 0.0001;
+
+	void update(std::span<double> probs, std::span<double>, std::size_t chosen, 
+			double feedback) const
+	{
+		double sumPj = 0;
+		double current = probs[chosen];
+		for(auto& prob : probs)
+		{
+			sumPj += (prob - floor);
+			prob -= rate * feedback * (prob - floor);
+		}
+		sumPj -= (current - floor);
+
+		// The amount that was subtracted from the other actions will be added to this one
+		probs[chosen] = current + rate * feedback * sumPj;
+	}
+};
+
+/**
+ * Linear Reward-Penalty (L_RP), S-model. The feedback rewards the chosen action,
+ * its complement penalises it in favour of the others, so the automaton keeps
+ * exploring.
+ */
+struct RewardPenalty
+{
+	double reward = 0.15;
+	double penalty = 0.015;
+
+	void update(std::span<double> probs, std::span<double>, std::size_t chosen, 
+			double feedback) const
+	{
+		if(probs.size() < 2)
+			return;
+
+		double gain = reward * feedback;
+		double loss = penalty * (1 - feedback);
+		double share = 1.0 / (probs.size() - 1);
+		for(std::size_t i = 0; i < probs.size(); ++i)
+			if(i == chosen)
+				probs[i] += gain * (1 - probs[i]) - loss * probs[i];
+			else
+				probs[i] += -gain * probs[i] + loss * (share - probs[i]);
+	}
+};
+
+/**
+ * Continuous pursuit. The reward estimate of the chosen action is updated, then
+ * the probabilities move towards the action with the highest estimate.
+ */
+struct Pursuit
+{
+	double rate = 0.05;
+	// Weight of the latest feedback inside the estimates
+	double estimateRate = 0.1;
+
+	void update(std::span<double> probs, std::span<double> estimates, std::size_t chosen, 
+			double feedback) const
+	{
+		estimates[chosen] += estimateRate * (feedback - estimates[chosen]);
+		std::size_t best = 0;
+		for(std::size_t i = 1; i < estimates.size(); ++i)
+			if(estimates[i] > estimates[best])
+				best = i;
+
+		for(auto& prob : probs)
+			prob *= (1 - rate);
+		probs[best] += rate;
+	}
+};
+
+/**
+ * Generalised pursuit estimator. The probabilities move towards all actions
+ * estimated better than the chosen one, or towards the chosen one if none is,
+ * so several good actions are pursued at once.
+ */
+struct Estimator
+{
+	double rate = 0.05;
+	// Weight of the latest feedback inside the estimates
+	double estimateRate = 0.1;
+
+	void update(std::span<double> probs, std::span<double> estimates, std::size_t chosen, 
+			double feedback) const
+	{
+		estimates[chosen] += estimateRate * (feedback - estimates[chosen]);
+		std::size_t better = 0;
+		for(double estimate : estimates)
+			if(estimate > estimates[chosen])
+				++better;
+
+		for(std::size_t i = 0; i < probs.size(); ++i)
+		{
+			probs[i] *= (1 - rate);
+			if(better == 0 ? i == chosen : estimates[i] > estimates[chosen])
+				probs[i] += rate / (better ? better : 1);
+		}
+	}
+};
+
+#endif // REINFORCEMENT_H
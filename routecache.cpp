@@ -0,0 +1,221 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#include "routecache.h"
+
+/**
+ * Constructor for the route cache.
+ *
+ * @param capacity The maximum number of cached routes, zero disables caching
+ */
+RouteCache::RouteCache(std::size_t capacity)
+{
+	limit = capacity;
+}
+
+/**
+ * Empty destructor.
+ */
+RouteCache::~RouteCache() { }
+
+/**
+ * Changes the maximum number of cached routes. The least recently used ones
+ * are evicted if needed.
+ *
+ * @param capacity The maximum number of cached routes, zero disables caching
+ */
+void RouteCache::setCapacity(std::size_t capacity)
+{
+	limit = capacity;
+	while(routes.size() > limit)
+		erase(std::prev(routes.end()));
+}
+
+/**
+ * Returns the maximum number of cached routes.
+ *
+ * @return std::size_t The capacity
+ */
+std::size_t RouteCache::capacity() const
+{
+	return limit;
+}
+
+/**
+ * Returns the number of cached routes.
+ *
+ * @return std::size_t The number of routes
+ */
+std::size_t RouteCache::size() const
+{
+	return routes.size();
+}
+
+/**
+ * Looks a route up and marks it as the most recently used one.
+ *
+ * @param src Starting node
+ * @param dest Ending node
+ * @param path Receives the cached node sequence on a hit
+ * @return bool Indication of a cache hit
+ */
+bool RouteCache::find(int src, int dest, std::vector<int>& path)
+{
+	auto it = index.find(keyOf(src, dest));
+	if(it == index.end())
+		return false;
+
+	routes.splice(routes.begin(), routes, it->second);
+	path.assign(it->second->nodes.cbegin(), it->second->nodes.cend());
+
+	return true;
+}
+
+/**
+ * Stores a route, replacing any previous one for the same node pair.
+ *
+ * @param src Starting node
+ * @param dest Ending node
+ * @param path The node sequence
+ */
+void RouteCache::insert(int src, int dest, const std::vector<int>& path)
+{
+	if(limit == 0)
+		return;
+
+	std::uint64_t key = keyOf(src, dest);
+	auto it = index.find(key);
+	if(it != index.end())
+		erase(it->second);
+
+	routes.push_front(Route{key, path});
+	index[key] = routes.begin();
+	for(int node : path)
+		byNode[node].insert(key);
+
+	while(routes.size() > limit)
+		erase(std::prev(routes.end()));
+}
+
+/**
+ * Drops the route between two nodes.
+ *
+ * @param src Starting node
+ * @param dest Ending node
+ */
+void RouteCache::invalidateRoute(int src, int dest)
+{
+	auto it = index.find(keyOf(src, dest));
+	if(it != index.end())
+		erase(it->second);
+}
+
+/**
+ * Drops all routes passing through a node.
+ *
+ * @param node The node
+ */
+void RouteCache::invalidateNode(int node)
+{
+	auto it = byNode.find(node);
+	if(it == byNode.end())
+		return;
+
+	// Erasing a route modifies the set, so work on a copy of it
+	std::vector<std::uint64_t> keys(it->second.cbegin(), it->second.cend());
+	for(auto key : keys)
+		erase(index[key]);
+}
+
+/**
+ * Drops all routes using a link.
+ *
+ * @param src Link's startpoint
+ * @param dest Link's endpoint
+ */
+void RouteCache::invalidateLink(int src, int dest)
+{
+	auto it = byNode.find(src);
+	if(it == byNode.end())
+		return;
+
+	std::vector<std::uint64_t> keys;
+	for(auto key : it->second)
+	{
+		const auto& nodes = index[key]->nodes;
+		for(std::size_t i = 0; i + 1 < nodes.size(); ++i)
+			if(nodes[i] == src && nodes[i + 1] == dest)
+			{
+				keys.push_back(key);
+				break;
+			}
+	}
+
+	for(auto key : keys)
+		erase(index[key]);
+}
+
+/**
+ * Clears instance's state
+ */
+void RouteCache::clear()
+{
+	routes.clear();
+	index.clear();
+	byNode.clear();
+}
+
+/**
+ * Creates the lookup key of a node pair.
+ *
+ * @param src Starting node
+ * @param dest Ending node
+ * @return std::uint64_t The key
+ */
+std::uint64_t RouteCache::keyOf(int src, int dest)
+{
+	return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(src)) << 32) 
+			| static_cast<std::uint32_t>(dest);
+}
+
+/**
+ * Removes a route and its index entries.
+ *
+ * @param route The route to be removed
+ */
+void RouteCache::erase(std::list<Route>::iterator route)
+{
+	for(int node : route->nodes)
+	{
+		auto it = byNode.find(node);
+		if(it == byNode.end())
+			continue;
+		it->second.erase(route->key);
+		if(it->second.empty())
+			byNode.erase(it);
+	}
+
+	index.erase(route->key);
+	routes.erase(route);
+}
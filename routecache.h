@@ -0,0 +1,66 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#ifndef ROUTECACHE_H
+#define ROUTECACHE_H
+
+#include <cstdint>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+class RouteCache
+{
+public:
+	RouteCache(std::size_t = 0);
+	~RouteCache();
+	void setCapacity(std::size_t);
+	std::size_t capacity() const;
+	std::size_t size() const;
+	bool find(int, int, std::vector<int>&);
+	void insert(int, int, const std::vector<int>&);
+	void invalidateRoute(int, int);
+	void invalidateNode(int);
+	void invalidateLink(int, int);
+	void clear();
+
+private:
+	struct Route
+	{
+		std::uint64_t key;
+		std::vector<int> nodes;
+	};
+
+	static std::uint64_t keyOf(int, int);
+	void erase(std::list<Route>::iterator);
+	std::size_t limit;
+	// Most recently used routes first
+	std::list<Route> routes;
+	std::unordered_map<std::uint64_t, std::list<Route>::iterator> index;
+	// Keys of the cached routes passing through every node
+	std::unordered_map<int, std::unordered_set<std::uint64_t>> byNode;
+};
+
+#endif // ROUTECACHE_H
@@ -0,0 +1,73 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#ifndef SPLITMIX_H
+#define SPLITMIX_H
+
+#include <cstdint>
+
+/**
+ * SplitMix64 generator. Its state is a single word, so every LA can own one,
+ * and streams derived from one seed are reproducible. It satisfies the
+ * UniformRandomBitGenerator requirements.
+ */
+class SplitMix64
+{
+public:
+	using result_type = std::uint64_t;
+	explicit SplitMix64(std::uint64_t seed = 0) : state(seed) { }
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return UINT64_MAX; }
+
+	/**
+	 * Returns the next value.
+	 *
+	 * @return result_type A uniformly distributed 64-bit value
+	 */
+	result_type operator()()
+	{
+		std::uint64_t z = (state += 0x9e3779b97f4a7c15);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+		return z ^ (z >> 31);
+	}
+
+	/**
+	 * Derives an independent stream, e.g., one per node, from a shared seed.
+	 *
+	 * @param seed The shared seed
+	 * @param id The stream id
+	 * @return SplitMix64 The generator of the stream
+	 */
+	static SplitMix64 stream(std::uint64_t seed, std::uint64_t id)
+	{
+		SplitMix64 mixer(seed ^ (id * 0xd1b54a32d192ed03));
+		return SplitMix64(mixer());
+	}
+
+private:
+	std::uint64_t state;
+};
+
+#endif // SPLITMIX_H
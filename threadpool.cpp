@@ -0,0 +1,175 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#include "threadpool.h"
+
+/**
+ * Constructor that starts the workers. Every worker owns a task queue and
+ * steals from the others' queues when its own is empty.
+ *
+ * @param threads The number of workers, zero for the hardware concurrency
+ */
+ThreadPool::ThreadPool(int threads) : queued(0), pending(0)
+{
+	if(threads <= 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+
+	next = 0;
+	stopping = false;
+	for(int i = 0; i < threads; ++i)
+		queues.push_back(std::make_unique<Queue>());
+	for(int i = 0; i < threads; ++i)
+		workers.emplace_back(&ThreadPool::work, this, i);
+}
+
+/**
+ * Destructor that stops and joins all workers. Queued tasks are discarded.
+ */
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(stateLock);
+		stopping = true;
+	}
+	wake.notify_all();
+	for(auto& worker : workers)
+		worker.join();
+}
+
+/**
+ * Returns the number of workers.
+ *
+ * @return int The number of workers
+ */
+int ThreadPool::size() const
+{
+	return static_cast<int>(workers.size());
+}
+
+/**
+ * Queues a task. Tasks are distributed round robin and receive the index of
+ * the worker running them, so they can use per-worker scratch state.
+ *
+ * @param task The task to be run
+ */
+void ThreadPool::submit(Task task)
+{
+	// Counted before it becomes visible, so wait() cannot miss it
+	++pending;
+	{
+		std::lock_guard<std::mutex> guard(queues[next % queues.size()]->lock);
+		queues[next % queues.size()]->tasks.push_back(std::move(task));
+	}
+	++next;
+	{
+		std::lock_guard<std::mutex> guard(stateLock);
+		++queued;
+	}
+	wake.notify_one();
+}
+
+/**
+ * Blocks until all submitted tasks are finished.
+ *
+ * @throws std::exception The first exception thrown by a task
+ */
+void ThreadPool::wait() noexcept(false)
+{
+	std::unique_lock<std::mutex> guard(stateLock);
+	idle.wait(guard, [this] { return pending == 0; });
+	if(failure)
+		std::rethrow_exception(std::exchange(failure, nullptr));
+}
+
+/**
+ * Takes a task from the worker's own queue, newest first, or steals the
+ * oldest task of another worker.
+ *
+ * @param worker The worker index
+ * @param task Receives the task
+ * @return bool Indication of a taken task
+ */
+bool ThreadPool::pop(int worker, Task& task)
+{
+	for(std::size_t i = 0; i < queues.size(); ++i)
+	{
+		Queue& queue = *queues[(worker + i) % queues.size()];
+		std::lock_guard<std::mutex> guard(queue.lock);
+		if(queue.tasks.empty())
+			continue;
+
+		if(i == 0)
+		{
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		}
+		else
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+		--queued;
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Worker loop.
+ *
+ * @param worker The worker index
+ */
+void ThreadPool::work(int worker)
+{
+	for(;;)
+	{
+		Task task;
+		if(!pop(worker, task))
+		{
+			std::unique_lock<std::mutex> guard(stateLock);
+			wake.wait(guard, [this] { return stopping || queued > 0; });
+			if(stopping)
+				return;
+			continue;
+		}
+
+		try
+		{
+			task(worker);
+		}
+		catch(...)
+		{
+			std::lock_guard<std::mutex> guard(stateLock);
+			if(!failure)
+				failure = std::current_exception();
+		}
+
+		if(--pending == 0)
+		{
+			std::lock_guard<std::mutex> guard(stateLock);
+			idle.notify_all();
+		}
+	}
+}
@@ -0,0 +1,228 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#include "topologygenerator.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Constructor. Equal seeds generate equal topologies.
+ *
+ * @param seed The seed of the generator
+ * @param minWeight The minimum link weight
+ * @param maxWeight The maximum link weight
+ */
+TopologyGenerator::TopologyGenerator(std::uint64_t seed, double minWeight, double maxWeight)
+		: gen(seed)
+{
+	this->minWeight = minWeight;
+	this->maxWeight = std::max(minWeight, maxWeight);
+}
+
+/**
+ * Empty destructor.
+ */
+TopologyGenerator::~TopologyGenerator() { }
+
+/**
+ * Generates a connected random topology. A random spanning tree connects all
+ * nodes first, then random links are added until the average degree is met.
+ * Weights are uniform in the configured range.
+ *
+ * @param nodes The number of nodes, numbered from zero
+ * @param degree The average number of neighbours per node
+ * @return std::vector<AdaptiveSystem::Edge> Both directions of every link
+ * @throws std::invalid_argument Less than two nodes
+ */
+std::vector<AdaptiveSystem::Edge> TopologyGenerator::random(int nodes, double degree) noexcept(false)
+{
+	if(nodes < 2)
+		throw std::invalid_argument("TopologyGenerator::random(..): At least two nodes are required");
+
+	reset();
+	for(int node = 1; node < nodes; ++node)
+		link(node, static_cast<int>(gen() % node));
+
+	// A complete graph bounds the number of links
+	auto links = static_cast<std::uint64_t>(std::llround(std::max(degree, 1.0) * nodes / 2));
+	links = std::min(links, static_cast<std::uint64_t>(nodes) * (nodes - 1) / 2);
+	while(linked.size() < links)
+		link(static_cast<int>(gen() % nodes), static_cast<int>(gen() % nodes));
+
+	return std::move(edges);
+}
+
+/**
+ * Generates a grid, every node linked to its horizontal and vertical neighbours,
+ * like the mesh of an optical or on-chip network.
+ *
+ * @param rows The number of rows
+ * @param columns The number of columns; node ids run row by row from zero
+ * @return std::vector<AdaptiveSystem::Edge> Both directions of every link
+ * @throws std::invalid_argument Less than two nodes
+ */
+std::vector<AdaptiveSystem::Edge> TopologyGenerator::grid(int rows, int columns) noexcept(false)
+{
+	if(rows < 1 || columns < 1 || static_cast<long long>(rows) * columns < 2)
+		throw std::invalid_argument("TopologyGenerator::grid(..): At least two nodes are required");
+
+	reset();
+	for(int row = 0; row < rows; ++row)
+		for(int column = 0; column < columns; ++column)
+		{
+			int node = row * columns + column;
+			if(column + 1 < columns)
+				link(node, node + 1);
+			if(row + 1 < rows)
+				link(node, node + columns);
+		}
+
+	return std::move(edges);
+}
+
+/**
+ * Generates a scale-free topology by preferential attachment (Barabasi-Albert).
+ * A small clique starts it and every further node links to existing ones with
+ * a probability proportional to their degree, so a few hubs emerge.
+ *
+ * @param nodes The number of nodes, numbered from zero
+ * @param degree The average number of neighbours per node, twice the links of a new node
+ * @return std::vector<AdaptiveSystem::Edge> Both directions of every link
+ * @throws std::invalid_argument Less than two nodes
+ */
+std::vector<AdaptiveSystem::Edge> TopologyGenerator::scaleFree(int nodes, double degree) noexcept(false)
+{
+	if(nodes < 2)
+		throw std::invalid_argument("TopologyGenerator::scaleFree(..): At least two nodes are required");
+
+	reset();
+	int attach = std::clamp(static_cast<int>(std::lround(degree / 2)), 1, nodes - 1);
+	// Every link end appears once, so a uniform pick from it follows the degrees
+	std::vector<int> ends;
+	for(int a = 0; a <= attach; ++a)
+		for(int b = a + 1; b <= attach && b < nodes; ++b)
+			if(link(a, b))
+				ends.insert(ends.end(), {a, b});
+	for(int node = attach + 1; node < nodes; ++node)
+		// Repeated picks of the same node are retried a few times only
+		for(int added = 0, attempts = 0; added < attach && attempts < 8 * attach; ++attempts)
+		{
+			int target = ends[gen() % ends.size()];
+			if(link(node, target))
+			{
+				ends.insert(ends.end(), {node, target});
+				++added;
+			}
+		}
+
+	return std::move(edges);
+}
+
+/**
+ * Generates a topology shaped like an operator's backbone. A core of about the
+ * square root of the nodes forms a ring with random chords, aggregation nodes
+ * are dual-homed to two core nodes and the remaining access nodes hang from one
+ * aggregation node, a third of them from two.
+ *
+ * @param nodes The number of nodes, numbered from zero, the core first
+ * @return std::vector<AdaptiveSystem::Edge> Both directions of every link
+ * @throws std::invalid_argument Less than two nodes
+ */
+std::vector<AdaptiveSystem::Edge> TopologyGenerator::backbone(int nodes) noexcept(false)
+{
+	if(nodes < 2)
+		throw std::invalid_argument("TopologyGenerator::backbone(..): At least two nodes are required");
+
+	reset();
+	int core = std::clamp(static_cast<int>(std::sqrt(nodes)), 2, nodes);
+	int aggregation = std::min(nodes - core, std::max(core, (nodes - core) / 10));
+	for(int node = 0; node < core; ++node)
+		link(node, (node + 1) % core);
+	for(int chord = 0; chord < core; ++chord)
+		link(static_cast<int>(gen() % core), static_cast<int>(gen() % core));
+
+	for(int node = core; node < core + aggregation; ++node)
+	{
+		int first = static_cast<int>(gen() % core);
+		link(node, first);
+		link(node, (first + 1 + static_cast<int>(gen() % (core - 1))) % core);
+	}
+
+	for(int node = core + aggregation; node < nodes; ++node)
+	{
+		int first = core + static_cast<int>(gen() % aggregation);
+		link(node, first);
+		if(aggregation > 1 && gen() % 3 == 0)
+			link(node, core + (first - core + 1 + static_cast<int>(gen() % (aggregation - 1))) 
+					% aggregation);
+	}
+
+	return std::move(edges);
+}
+
+/**
+ * Starts a new topology.
+ */
+void TopologyGenerator::reset()
+{
+	linked.clear();
+	edges.clear();
+}
+
+/**
+ * Links two distinct nodes in both directions, unless they are already linked.
+ *
+ * @param a The first node
+ * @param b The second node
+ * @return bool Indication of a new link
+ */
+bool TopologyGenerator::link(int a, int b)
+{
+	if(a == b)
+		return false;
+	auto key = (static_cast<std::uint64_t>(std::min(a, b)) << 32) | static_cast<std::uint32_t>(std::max(a, b));
+	if(!linked.insert(key).second)
+		return false;
+
+	AdaptiveSystem::Edge edge;
+	edge.edgeStart = a;
+	edge.edgeEnd = b;
+	edge.weight = weight();
+	edges.push_back(edge);
+	std::swap(edge.edgeStart, edge.edgeEnd);
+	edges.push_back(edge);
+
+	return true;
+}
+
+/**
+ * Draws a link weight.
+ *
+ * @return double A whole weight in the configured range
+ */
+double TopologyGenerator::weight()
+{
+	auto span = static_cast<std::uint64_t>(maxWeight - minWeight) + 1;
+	return minWeight + static_cast<double>(gen() % span);
+}
@@ -0,0 +1,57 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#ifndef TOPOLOGYGENERATOR_H
+#define TOPOLOGYGENERATOR_H
+
+#include "adaptivesystem.h"
+#include "splitmix.h"
+#include <unordered_set>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+class TopologyGenerator
+{
+public:
+	TopologyGenerator(std::uint64_t, double = 1, double = 100);
+	~TopologyGenerator();
+	std::vector<AdaptiveSystem::Edge> random(int, double) noexcept(false);
+	std::vector<AdaptiveSystem::Edge> grid(int, int) noexcept(false);
+	std::vector<AdaptiveSystem::Edge> scaleFree(int, double) noexcept(false);
+	std::vector<AdaptiveSystem::Edge> backbone(int) noexcept(false);
+
+private:
+	void reset();
+	bool link(int, int);
+	double weight();
+	SplitMix64 gen;
+	double minWeight;
+	double maxWeight;
+	// Links are undirected, each one is emitted in both directions
+	std::unordered_set<std::uint64_t> linked;
+	std::vector<AdaptiveSystem::Edge> edges;
+};
+
+#endif // TOPOLOGYGENERATOR_H
@@ -0,0 +1,383 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#include "topologyreader.h"
+#include <cstdlib>
+#include <cmath>
+#include <cctype>
+#include <cstdio>
+
+/**
+ * Constructor for the reader.
+ *
+ * @param input The stream containing the JSON topology
+ */
+TopologyReader::TopologyReader(std::istream& input) : in(input), buffer(BUFFER_SIZE)
+{
+	pos = end = 0;
+	line = 1;
+}
+
+/**
+ * Empty destructor.
+ */
+TopologyReader::~TopologyReader() { }
+
+/**
+ * Reads the topology, handing every link over as soon as it is parsed. The input
+ * passes through a fixed-size buffer, so memory use does not grow with the file.
+ * Every top-level member except "number_of_nodes" is an array of links, and each
+ * link is an object with its "nodes" pair and its "length". Unknown members are
+ * skipped.
+ *
+ * @param link Receives source, destination and length of each link
+ * @throws std::runtime_error Malformed input
+ */
+void TopologyReader::read(const Link& link) noexcept(false)
+{
+	skipSpace();
+	expect('{');
+	skipSpace();
+	if(peek() == '}')
+	{
+		get();
+		return;
+	}
+
+	for(;;)
+	{
+		skipSpace();
+		std::string name = text();
+		skipSpace();
+		expect(':');
+		skipSpace();
+		if(name != "number_of_nodes" && peek() == '[')
+			readLinks(link);
+		else
+			skipValue(0);
+
+		skipSpace();
+		if(peek() == ',')
+		{
+			get();
+			continue;
+		}
+		expect('}');
+		return;
+	}
+}
+
+/**
+ * Reads an array of links.
+ *
+ * @param link Receives every parsed link
+ * @throws std::runtime_error Malformed input
+ */
+void TopologyReader::readLinks(const Link& link) noexcept(false)
+{
+	expect('[');
+	skipSpace();
+	if(peek() == ']')
+	{
+		get();
+		return;
+	}
+
+	for(;;)
+	{
+		skipSpace();
+		readLink(link);
+		skipSpace();
+		if(peek() == ',')
+		{
+			get();
+			continue;
+		}
+		expect(']');
+		return;
+	}
+}
+
+/**
+ * Reads a single link object.
+ *
+ * @param link Receives the parsed link
+ * @throws std::runtime_error Malformed input
+ */
+void TopologyReader::readLink(const Link& link) noexcept(false)
+{
+	int src = 0; int dest = 0; double length = 0;
+	expect('{');
+	skipSpace();
+	if(peek() == '}')
+	{
+		get();
+		link(src, dest, length);
+		return;
+	}
+
+	for(;;)
+	{
+		skipSpace();
+		std::string name = text();
+		skipSpace();
+		expect(':');
+		skipSpace();
+		if(name == "nodes")
+		{
+			expect('[');
+			for(int index = 0; ; ++index)
+			{
+				skipSpace();
+				if(index == 0 && peek() == ']')
+					break;
+				double node = number();
+				if(node != std::floor(node))
+					fail("Non-integral node id");
+				if(index == 0)
+					src = static_cast<int>(node);
+				if(index == 1)
+					dest = static_cast<int>(node);
+				skipSpace();
+				if(peek() != ',')
+					break;
+				get();
+			}
+			expect(']');
+		}
+		else if(name == "length")
+			length = number();
+		else
+			skipValue(0);
+
+		skipSpace();
+		if(peek() == ',')
+		{
+			get();
+			continue;
+		}
+		expect('}');
+		link(src, dest, length);
+		return;
+	}
+}
+
+/**
+ * Skips any JSON value.
+ *
+ * @param depth Current nesting depth
+ * @throws std::runtime_error Malformed input
+ */
+void TopologyReader::skipValue(int depth) noexcept(false)
+{
+	if(depth > 64)
+		fail("Nesting too deep");
+
+	int c = peek();
+	if(c == '"')
+	{
+		text();
+		return;
+	}
+	if(c == '{' || c == '[')
+	{
+		char close = (c == '{') ? '}' : ']';
+		get();
+		skipSpace();
+		if(peek() == close)
+		{
+			get();
+			return;
+		}
+		for(;;)
+		{
+			skipSpace();
+			if(close == '}')
+			{
+				text();
+				skipSpace();
+				expect(':');
+				skipSpace();
+			}
+			skipValue(depth + 1);
+			skipSpace();
+			if(peek() == ',')
+			{
+				get();
+				continue;
+			}
+			expect(close);
+			return;
+		}
+	}
+	if(c == 't' || c == 'f' || c == 'n')
+	{
+		std::string word;
+		while(std::isalpha(peek()))
+			word += static_cast<char>(get());
+		if(word != "true" && word != "false" && word != "null")
+			fail("Unexpected literal");
+		return;
+	}
+
+	number();
+}
+
+/**
+ * Reads a string. Escape sequences other than \uXXXX are resolved, member names
+ * of a topology never need the latter.
+ *
+ * @return std::string The string's contents
+ * @throws std::runtime_error Malformed input
+ */
+std::string TopologyReader::text() noexcept(false)
+{
+	expect('"');
+	std::string value;
+	for(;;)
+	{
+		int c = get();
+		if(c == EOF)
+			fail("Unterminated string");
+		if(c == '"')
+			return value;
+		if(c == '\\')
+		{
+			c = get();
+			switch(c)
+			{
+				case 'n': c = '\n'; break;
+				case 't': c = '\t'; break;
+				case 'r': c = '\r'; break;
+				case 'b': c = '\b'; break;
+				case 'f': c = '\f'; break;
+				case 'u':
+					for(int i = 0; i < 4; ++i)
+						get();
+					c = '?';
+					break;
+				case EOF: fail("Unterminated string");
+				default: break;
+			}
+		}
+		value += static_cast<char>(c);
+	}
+}
+
+/**
+ * Reads a number.
+ *
+ * @return double Its value
+ * @throws std::runtime_error Malformed input
+ */
+double TopologyReader::number() noexcept(false)
+{
+	char digits[64];
+	std::size_t count = 0;
+	for(int c = peek(); c != EOF && (std::isdigit(c) || c == '-' || c == '+' 
+			|| c == '.' || c == 'e' || c == 'E'); c = peek())
+	{
+		if(count + 1 == sizeof(digits))
+			fail("Number too long");
+		digits[count++] = static_cast<char>(get());
+	}
+	digits[count] = '\0';
+
+	char* last = nullptr;
+	double value = std::strtod(digits, &last);
+	if(count == 0 || last != digits + count)
+		fail("Invalid number");
+
+	return value;
+}
+
+/**
+ * Returns the next character without consuming it, refilling the buffer if needed.
+ *
+ * @return int The character or EOF
+ */
+int TopologyReader::peek()
+{
+	if(pos == end)
+	{
+		in.read(buffer.data(), buffer.size());
+		pos = 0;
+		end = static_cast<std::size_t>(in.gcount());
+		if(end == 0)
+			return EOF;
+	}
+
+	return static_cast<unsigned char>(buffer[pos]);
+}
+
+/**
+ * Consumes the next character.
+ *
+ * @return int The character or EOF
+ */
+int TopologyReader::get()
+{
+	int c = peek();
+	if(c != EOF)
+	{
+		++pos;
+		if(c == '\n')
+			++line;
+	}
+
+	return c;
+}
+
+/**
+ * Skips whitespace.
+ */
+void TopologyReader::skipSpace()
+{
+	for(int c = peek(); c == ' ' || c == '\n' || c == '\t' || c == '\r'; c = peek())
+		get();
+}
+
+/**
+ * Consumes an expected character.
+ *
+ * @param c The character
+ * @throws std::runtime_error A different character was found
+ */
+void TopologyReader::expect(char c) noexcept(false)
+{
+	if(get() != c)
+		fail(std::string("Expected '") + c + "'");
+}
+
+/**
+ * Throws a parsing error that includes the current line.
+ *
+ * @param message The error description
+ * @throws std::runtime_error Always
+ */
+void TopologyReader::fail(const std::string& message) const noexcept(false)
+{
+	throw std::runtime_error("TopologyReader::read(..): " + message + " at line " 
+			+ std::to_string(line));
+}
@@ -0,0 +1,61 @@
+/*
+ * LaPath: Shortest path calculation using Learning Automata
+ * Copyright (C) 2014-2021 by Constantine Kyriakopoulos
+ * zfox@users.sourceforge.net
+ * @version 1.0.2
+ * 
+ * @section LICENSE
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+
+#ifndef TOPOLOGYREADER_H
+#define TOPOLOGYREADER_H
+
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+class TopologyReader
+{
+public:
+	using Link = std::function<void(int, int, double)>;
+	static const std::size_t BUFFER_SIZE = 1 << 16;
+	TopologyReader(std::istream&);
+	~TopologyReader();
+	void read(const Link&) noexcept(false);
+
+private:
+	int peek();
+	int get();
+	void skipSpace();
+	void expect(char) noexcept(false);
+	std::string text() noexcept(false);
+	double number() noexcept(false);
+	void skipValue(int) noexcept(false);
+	void readLinks(const Link&) noexcept(false);
+	void readLink(const Link&) noexcept(false);
+	[[noreturn]] void fail(const std::string&) const noexcept(false);
+	std::istream& in;
+	std::vector<char> buffer;
+	std::size_t pos;
+	std::size_t end;
+	long line;
+};
+
+#endif // TOPOLOGYREADER_H